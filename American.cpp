@@ -0,0 +1,236 @@
+#include "American.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr double tolerance = 1e-9; // on |LHS - RHS| / K of the critical price equation
+    constexpr int max_rounds = 100;
+
+    // the pieces of the Barone-Adesi-Whaley quadratic approximation of one contract at one vol
+    struct BawTerms
+    {
+        double phi, strike, T, rate, carry; // carry is b = r - q
+        double vol, sqrtT, growth;          // growth is e^{(b-r)T}
+        double q;                           // q2 for calls, q1 for puts
+        bool early;                         // false when early exercise is never optimal
+    };
+
+    // roots of x^2 + (N - 1) x - c = 0 without cancellation, the positive one for calls
+    double quadratic_root(double N, double c, double phi)
+    {
+        double b = N - 1;
+        double disc = std::sqrt(b * b + 4 * c);
+        // the root on the same side as -b is the large one, the other comes from the product -c
+        double large = b >= 0 ? (-b - disc) / 2 : (-b + disc) / 2;
+        double small = -c / large;
+        bool largeIsPositive = large > 0;
+        return (phi > 0) == largeIsPositive ? large : small;
+    }
+
+    BawTerms baw_terms(double phi, double strike, double T, double rate, double dividend, double vol)
+    {
+        BawTerms t{phi, strike, T, rate, rate - dividend, vol, std::sqrt(T), std::exp(-dividend * T), 0, false};
+        t.early = phi > 0 ? t.carry < rate : rate > 0;
+        if (!t.early)
+            return t;
+        double variance = vol * vol;
+        double N = 2 * t.carry / variance, M = 2 * rate / variance, K = 1 - std::exp(-rate * T);
+        t.q = quadratic_root(N, M / K, phi);
+        return t;
+    }
+
+    // the starting point of the Newton iteration: the perpetual critical price pulled towards the strike
+    double baw_seed(const BawTerms &t)
+    {
+        double variance = t.vol * t.vol;
+        double qu = quadratic_root(2 * t.carry / variance, 2 * t.rate / variance, t.phi);
+        double perpetual = t.strike / (1 - 1 / qu);
+        double stdDev = t.vol * t.sqrtT;
+        if (t.phi > 0)
+        {
+            double h2 = -(t.carry * t.T + 2 * stdDev) * t.strike / (perpetual - t.strike);
+            return t.strike + (perpetual - t.strike) * (1 - std::exp(h2));
+        }
+        double h1 = (t.carry * t.T - 2 * stdDev) * t.strike / (t.strike - perpetual);
+        return perpetual + (t.strike - perpetual) * std::exp(h1);
+    }
+
+    double d1_at(const BawTerms &t, double spot)
+    {
+        return (std::log(spot / t.strike) + (t.carry + 0.5 * t.vol * t.vol) * t.T) / (t.vol * t.sqrtT);
+    }
+
+    double european_at(const BawTerms &t, double spot)
+    {
+        double d1 = d1_at(t, spot), d2 = d1 - t.vol * t.sqrtT;
+        return t.phi * (spot * t.growth * norm_cdf(t.phi * d1) - t.strike * std::exp(-t.rate * t.T) * norm_cdf(t.phi * d2));
+    }
+
+    // one Newton step on the critical price equation, returns true once si solves it
+    bool baw_step(const BawTerms &t, double &si)
+    {
+        double d1 = d1_at(t, si);
+        double european = european_at(t, si);
+        double density = t.growth * norm_pdf(d1) / (t.vol * t.sqrtT);
+        double next, lhs, rhs;
+        if (t.phi > 0)
+        {
+            double nd1 = t.growth * norm_cdf(d1);
+            lhs = si - t.strike;
+            rhs = european + (1 - nd1) * si / t.q;
+            double slope = nd1 * (1 - 1 / t.q) + (1 - density) / t.q;
+            next = (t.strike + rhs - slope * si) / (1 - slope);
+            next = std::max(next, 0.5 * (si + t.strike)); // S* stays above the strike
+        }
+        else
+        {
+            double nd1 = t.growth * norm_cdf(-d1);
+            lhs = t.strike - si;
+            rhs = european - (1 - nd1) * si / t.q;
+            double slope = -nd1 * (1 - 1 / t.q) - (1 + density) / t.q;
+            next = (t.strike - rhs + slope * si) / (1 + slope);
+            next = std::clamp(next, 0.5 * si, t.strike); // S** stays in (0, K]
+        }
+        if (std::abs(lhs - rhs) / t.strike < tolerance || !std::isfinite(next))
+            return true;
+        si = next;
+        return false;
+    }
+
+    double baw_price(const BawTerms &t, double spot, double critical)
+    {
+        double intrinsic = std::max(0.0, t.phi * (spot - t.strike));
+        if (!t.early)
+            return european_at(t, spot);
+        if (t.phi > 0 ? spot >= critical : spot <= critical)
+            return intrinsic;
+        // A2 = (S*/q2)(1 - e^{(b-r)T} N(d1(S*))) for calls, A1 = -(S**/q1)(1 - e^{(b-r)T} N(-d1(S**))) for puts
+        double premium = t.phi * (critical / t.q) * (1 - t.growth * norm_cdf(t.phi * d1_at(t, critical)));
+        return std::max(intrinsic, european_at(t, spot) + premium * std::pow(spot / critical, t.q));
+    }
+
+    // phi(S, T, gamma, H, I) of Bjerksund-Stensland
+    double bs93_phi(double S, double T, double gamma, double H, double I, double r, double b, double vol)
+    {
+        double variance = vol * vol, stdDev = vol * std::sqrt(T);
+        double lambda = (-r + gamma * b + 0.5 * gamma * (gamma - 1) * variance) * T;
+        double d = -(std::log(S / H) + (b + (gamma - 0.5) * variance) * T) / stdDev;
+        double kappa = 2 * b / variance + (2 * gamma - 1);
+        return std::exp(lambda) * std::pow(S, gamma) *
+               (norm_cdf(d) - std::pow(I / S, kappa) * norm_cdf(d - 2 * std::log(I / S) / stdDev));
+    }
+
+    // Bjerksund-Stensland call with cost of carry b; puts use the call at (K, S, r - b, -b)
+    double bs93_call(double S, double K, double T, double r, double b, double vol)
+    {
+        if (b >= r)
+        {
+            return BlackScholes(K, S, T, r, PayoffType::Call, r - b)(vol);
+        }
+        double variance = vol * vol;
+        double beta = (0.5 - b / variance) + std::sqrt(std::pow(b / variance - 0.5, 2) + 2 * r / variance);
+        double bInfinity = beta / (beta - 1) * K;
+        double b0 = std::max(K, r / (r - b) * K);
+        double ht = -(b * T + 2 * vol * std::sqrt(T)) * b0 / (bInfinity - b0);
+        double I = b0 + (bInfinity - b0) * (1 - std::exp(ht));
+        if (S >= I)
+        {
+            return S - K;
+        }
+        double alpha = (I - K) * std::pow(I, -beta);
+        return alpha * std::pow(S, beta) - alpha * bs93_phi(S, T, beta, I, I, r, b, vol) +
+               bs93_phi(S, T, 1, I, I, r, b, vol) - bs93_phi(S, T, 1, K, I, r, b, vol) -
+               K * bs93_phi(S, T, 0, I, I, r, b, vol) + K * bs93_phi(S, T, 0, K, I, r, b, vol);
+    }
+
+    BawTerms model_terms(const BlackScholes &model, double vol)
+    {
+        return baw_terms(static_cast<double>(model.get_payoff_type()), model.get_strike(), model.get_time_to_maturity(),
+                         model.get_interest_rate(), model.get_dividend_yield(), vol);
+    }
+}
+
+double baw_critical_price(const BlackScholes &model, double vol)
+{
+    BawTerms t = model_terms(model, vol);
+    if (!t.early)
+        return t.phi > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+    double si = baw_seed(t);
+    for (int i = 0; i < max_rounds && !baw_step(t, si); ++i)
+    {
+    }
+    return si;
+}
+
+double baw_price(const BlackScholes &model, double vol, double criticalPrice)
+{
+    return baw_price(model_terms(model, vol), model.get_spot(), criticalPrice);
+}
+
+double bjerksund_stensland_price(const BlackScholes &model, double vol)
+{
+    double S = model.get_spot(), K = model.get_strike(), T = model.get_time_to_maturity();
+    double r = model.get_interest_rate(), b = r - model.get_dividend_yield();
+    double price = model.get_payoff_type() == PayoffType::Call ? bs93_call(S, K, T, r, b, vol)
+                                                               : bs93_call(K, S, T, r - b, -b, vol);
+    // the flat trigger can sit below the true boundary and exercise a contract still worth more held, so
+    // the price is floored at the European value as well as the exercise value
+    double intrinsic = std::max(0.0, static_cast<double>(model.get_payoff_type()) * (S - K));
+    return std::max(price, std::max(intrinsic, model.european()(vol)));
+}
+
+double american_price(const BlackScholes &model, double vol)
+{
+    switch (model.get_early_exercise())
+    {
+    case EarlyExercise::BaroneAdesiWhaley:
+        return baw_price(model, vol, baw_critical_price(model, vol));
+    case EarlyExercise::BjerksundStensland:
+        return bjerksund_stensland_price(model, vol);
+    case EarlyExercise::None:
+        break;
+    }
+    return model.european()(vol);
+}
+
+int baw_critical_prices(double timeToMaturity, double rate, double dividend, size_t n,
+                        const double *strikes, const double *phis, const double *vols, double *critical)
+{
+    std::vector<BawTerms> terms(n);
+    std::vector<size_t> active;
+    active.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        terms[i] = baw_terms(phis[i], strikes[i], timeToMaturity, rate, dividend, vols[i]);
+        if (!terms[i].early)
+        {
+            critical[i] = phis[i] > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+            continue;
+        }
+        // a warm start only helps from the right side of the strike
+        bool usable = critical[i] > 0 && std::isfinite(critical[i]) &&
+                      (phis[i] > 0 ? critical[i] > strikes[i] : critical[i] < strikes[i]);
+        if (!usable)
+            critical[i] = baw_seed(terms[i]);
+        active.push_back(i);
+    }
+
+    int rounds = 0;
+    while (!active.empty() && rounds < max_rounds)
+    {
+        rounds++;
+        size_t remaining = 0;
+        for (size_t k = 0; k < active.size(); ++k)
+        {
+            size_t i = active[k];
+            if (!baw_step(terms[i], critical[i]))
+                active[remaining++] = i;
+        }
+        active.resize(remaining);
+    }
+    return rounds;
+}
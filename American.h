@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include "BlackScholes.h"
+
+// analytic approximations of American options under Black-Scholes with cost of carry b = r - q, for the
+// single-stock and ETF chains (SPY, NVDA) whose contracts can be exercised early
+//
+// Barone-Adesi-Whaley (1987): the European price plus a quadratic early exercise premium, which needs the
+// critical stock price S* where exercising and holding are worth the same; S* is found by Newton on
+// S* - K = c(S*) + (1 - e^{(b-r)T} N(d1(S*))) S* / q2 (calls, the put mirrors it)
+// Bjerksund-Stensland (1993): the value of exercising at a flat trigger I chosen in closed form, floored at
+// the European value; a lower bound that needs no iteration
+//
+// calls on underlyings with q <= 0 and puts at r <= 0 are never exercised early and price as European
+
+// price of the model's contract at vol with its early exercise approximation, European if it has none
+double american_price(const BlackScholes &model, double vol);
+
+// Barone-Adesi-Whaley critical price S* of a call or S** of a put, infinity for a call and 0 for a put
+// that is never exercised early
+double baw_critical_price(const BlackScholes &model, double vol);
+// Barone-Adesi-Whaley price given the critical price of the same contract and vol
+double baw_price(const BlackScholes &model, double vol, double criticalPrice);
+
+double bjerksund_stensland_price(const BlackScholes &model, double vol);
+
+// critical prices of all contracts of one expiration in lockstep: every round takes one Newton step for
+// each contract that has not converged, so the loop streams over contiguous arrays (phi = 1 for calls,
+// -1 for puts); critical[i] > 0 on entry is used as the starting point, e.g. the critical price of the
+// previous vol in an IV solve; returns the number of rounds taken
+int baw_critical_prices(double timeToMaturity, double rate, double dividend, size_t n,
+                        const double *strikes, const double *phis, const double *vols, double *critical);
@@ -0,0 +1,178 @@
+#include "BatchIV.h"
+#include "American.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace
+{
+    constexpr double vol_min = 0.0001;
+    constexpr double vol_max = 3.0;
+    constexpr double epsilon = 1e-06; // on the discounted price, as in the scalar solvers
+    constexpr int max_rounds = 100;
+
+    // undiscounted Black-76 price and vega of one contract
+    inline void black76(double F, double K, double phi, double vol, double sqrtT, double &price, double &vega)
+    {
+        double stdDev = vol * sqrtT;
+        double d1 = std::log(F / K) / stdDev + 0.5 * stdDev;
+        double d2 = d1 - stdDev;
+        price = phi * (F * 0.5 * std::erfc(-phi * d1 * std::numbers::sqrt2 / 2) -
+                       K * 0.5 * std::erfc(-phi * d2 * std::numbers::sqrt2 / 2));
+        vega = F * sqrtT * std::exp(-0.5 * d1 * d1) / std::sqrt(2 * std::numbers::pi);
+    }
+
+    // a contract of one American expiry at the given vol
+    BlackScholes american_model(EarlyExercise earlyExercise, double spot, double rate, double dividend,
+                                double timeToMaturity, double strike, double phi)
+    {
+        PayoffType type = phi > 0 ? PayoffType::Call : PayoffType::Put;
+        return BlackScholes(strike, spot, timeToMaturity, rate, type, dividend).with_early_exercise(earlyExercise);
+    }
+}
+
+int implied_vol_batch(double forward, double discount, double timeToMaturity, size_t n,
+                      const double *strikes, const double *phis, const double *prices, double *vols)
+{
+    double sqrtT = std::sqrt(timeToMaturity);
+    std::vector<double> lo(n, vol_min), hi(n, vol_max), target(n);
+    std::vector<size_t> active;
+    active.reserve(n);
+
+    // bracket check and starting guess, the larger of the Manaster-Koehler point and the
+    // Brenner-Subrahmanyam ATM estimate from the time value
+    for (size_t i = 0; i < n; ++i)
+    {
+        target[i] = prices[i] / discount;
+        double low, high, vega;
+        black76(forward, strikes[i], phis[i], vol_min, sqrtT, low, vega);
+        black76(forward, strikes[i], phis[i], vol_max, sqrtT, high, vega);
+        if (!(prices[i] > 0) || (low - target[i]) * (high - target[i]) > 0)
+        {
+            vols[i] = 0;
+            continue;
+        }
+
+        double timeValue = std::max(0.0, target[i] - std::max(0.0, phis[i] * (forward - strikes[i])));
+        double guess = std::max(std::sqrt(2 * std::abs(std::log(forward / strikes[i])) / timeToMaturity),
+                                std::sqrt(2 * std::numbers::pi / timeToMaturity) * timeValue / forward);
+        vols[i] = std::clamp(guess, 2 * vol_min, 0.5 * vol_max);
+        active.push_back(i);
+    }
+
+    int rounds = 0;
+    while (!active.empty() && rounds < max_rounds)
+    {
+        rounds++;
+        size_t remaining = 0;
+        for (size_t k = 0; k < active.size(); ++k)
+        {
+            size_t i = active[k];
+            double price, vega;
+            black76(forward, strikes[i], phis[i], vols[i], sqrtT, price, vega);
+            double error = price - target[i];
+            if (std::abs(error) * discount < epsilon)
+            {
+                continue; // converged, drops out of the next round
+            }
+
+            // the price is increasing in vol, so the sign of the error moves one end of the bracket
+            (error < 0 ? lo[i] : hi[i]) = vols[i];
+            double next = vols[i] - error / vega;
+            vols[i] = (vega > 0 && next > lo[i] && next < hi[i]) ? next : 0.5 * (lo[i] + hi[i]);
+            active[remaining++] = i;
+        }
+        active.resize(remaining);
+    }
+    return rounds;
+}
+
+int american_implied_vol_batch(EarlyExercise earlyExercise, double spot, double rate, double dividend,
+                               double timeToMaturity, size_t n, const double *strikes, const double *phis,
+                               const double *prices, double *vols)
+{
+    std::vector<BlackScholes> models;
+    models.reserve(n);
+    std::vector<double> lo(n, vol_min), hi(n, vol_max), critical(n, 0.0);
+    std::vector<double> lastVol(n, 0.0), lastPrice(n, 0.0); // previous iterate, for the secant slope
+    std::vector<size_t> active;
+    active.reserve(n);
+
+    // bracket check on the American prices; the starting guess is the European one of implied_vol_batch
+    double forward = spot * std::exp((rate - dividend) * timeToMaturity);
+    double discount = std::exp(-rate * timeToMaturity);
+    for (size_t i = 0; i < n; ++i)
+    {
+        models.push_back(american_model(earlyExercise, spot, rate, dividend, timeToMaturity, strikes[i], phis[i]));
+        const BlackScholes &model = models.back();
+        if (!(prices[i] > 0) || (model(vol_min) - prices[i]) * (model(vol_max) - prices[i]) > 0)
+        {
+            vols[i] = 0;
+            continue;
+        }
+
+        double target = prices[i] / discount;
+        double timeValue = std::max(0.0, target - std::max(0.0, phis[i] * (forward - strikes[i])));
+        double guess = std::max(std::sqrt(2 * std::abs(std::log(forward / strikes[i])) / timeToMaturity),
+                                std::sqrt(2 * std::numbers::pi / timeToMaturity) * timeValue / forward);
+        vols[i] = std::clamp(guess, 2 * vol_min, 0.5 * vol_max);
+        active.push_back(i);
+    }
+
+    // gathered inputs of the batched critical price solve
+    std::vector<double> activeStrikes, activePhis, activeVols, activeCritical;
+    int rounds = 0;
+    while (!active.empty() && rounds < max_rounds)
+    {
+        rounds++;
+        if (earlyExercise == EarlyExercise::BaroneAdesiWhaley)
+        {
+            activeStrikes.clear();
+            activePhis.clear();
+            activeVols.clear();
+            activeCritical.clear();
+            for (size_t i : active)
+            {
+                activeStrikes.push_back(strikes[i]);
+                activePhis.push_back(phis[i]);
+                activeVols.push_back(vols[i]);
+                activeCritical.push_back(critical[i]);
+            }
+            baw_critical_prices(timeToMaturity, rate, dividend, active.size(), activeStrikes.data(),
+                                activePhis.data(), activeVols.data(), activeCritical.data());
+            for (size_t k = 0; k < active.size(); ++k)
+            {
+                critical[active[k]] = activeCritical[k];
+            }
+        }
+
+        size_t remaining = 0;
+        for (size_t k = 0; k < active.size(); ++k)
+        {
+            size_t i = active[k];
+            const BlackScholes &model = models[i];
+            double price = earlyExercise == EarlyExercise::BaroneAdesiWhaley ? baw_price(model, vols[i], critical[i])
+                                                                             : model(vols[i]);
+            double error = price - prices[i];
+            if (std::abs(error) < epsilon)
+            {
+                continue;
+            }
+
+            // the American price has no closed-form vega, so the first step takes the European one and the
+            // later ones the secant through the previous iterate, which follows the steeper slope of the
+            // early exercise premium near the exercise boundary
+            (error < 0 ? lo[i] : hi[i]) = vols[i];
+            double slope = lastVol[i] > 0 && lastVol[i] != vols[i] ? (price - lastPrice[i]) / (vols[i] - lastVol[i])
+                                                                   : model.get_vega(vols[i]);
+            lastVol[i] = vols[i];
+            lastPrice[i] = price;
+            double next = vols[i] - error / slope;
+            vols[i] = (slope > 0 && next > lo[i] && next < hi[i]) ? next : 0.5 * (lo[i] + hi[i]);
+            active[remaining++] = i;
+        }
+        active.resize(remaining);
+    }
+    return rounds;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include "BlackScholes.h"
+
+// implied vols of all contracts of one expiration in lockstep under the Black-76 form
+//     price = D * phi * (F * N(phi * d1) - K * N(phi * d2)),  d1 = (ln(F / K) + vol^2 T / 2) / (vol sqrt(T))
+// index chains use it with their implied forward; equity chains fit the same form with
+// F = S e^{(r - q) T} and D = e^{-rT}
+//
+// the inputs are plain arrays (phi = 1 for calls, -1 for puts) and every round runs one safeguarded
+// Newton step (bisection when the step leaves the bracket) over the contracts that have not converged,
+// so the loops stream over contiguous data; the root is bracketed in [1e-4, 3] like bisection_method and
+// vols[i] is 0 for prices outside that range; returns the number of rounds taken
+int implied_vol_batch(double forward, double discount, double timeToMaturity, size_t n,
+                      const double *strikes, const double *phis, const double *prices, double *vols);
+
+// implied vols of the American contracts of one equity expiration (spot S, dividend yield q) under the
+// early exercise approximation of American.h, in the same lockstep safeguarded iteration: a Newton step on
+// the European vega, then secant steps on the American prices; with Barone-Adesi-Whaley each round first solves the critical prices of the active
+// contracts in one baw_critical_prices call, warm-started from the previous round's, so a whole expiry
+// costs a few closed-form passes; vols[i] is 0 for prices outside the [1e-4, 3] bracket, which includes
+// prices below the exercise value; returns the number of rounds taken
+int american_implied_vol_batch(EarlyExercise earlyExercise, double spot, double rate, double dividend,
+                               double timeToMaturity, size_t n, const double *strikes, const double *phis,
+                               const double *prices, double *vols);
@@ -1,4 +1,5 @@
 #include "BlackScholes.h"
+#include "American.h"
 #include "util.h"
 
 // Constructor Implementation
@@ -7,9 +8,31 @@ BlackScholes::BlackScholes(double strike, double spot, double time_to_maturity,
     : strike_(strike), spot_(spot), time_to_maturity_(time_to_maturity),
       interest_rate_(interest_rate), dividend_yield_(dividend_yield), payoff_type_(payoff_type) {}
 
+BlackScholes BlackScholes::black76(double strike, double forward, double time_to_maturity,
+                                   double interest_rate, PayoffType payoff_type)
+{
+    return BlackScholes(strike, forward, time_to_maturity, interest_rate, payoff_type, interest_rate);
+}
+
+BlackScholes BlackScholes::with_early_exercise(EarlyExercise early_exercise) const
+{
+    BlackScholes model = *this;
+    model.early_exercise_ = early_exercise;
+    return model;
+}
+
+BlackScholes BlackScholes::with_spot(double spot) const
+{
+    BlackScholes model = *this;
+    model.spot_ = spot;
+    return model;
+}
+
 // Functor Implementation which takes volatility as an input and outputs the option price
 double BlackScholes::operator()(double vol) const
 {
+    if (early_exercise_ != EarlyExercise::None)
+        return american_price(*this, vol);
 
     using std::exp;
     // getting d1 and d2 through helper function
@@ -52,32 +75,35 @@ std::array<double, 2> BlackScholes::compute_norm_args_(double vol) const
 
 double BlackScholes::get_delta(double vol) const
 {
-    // getting delta using N(d1)
+    // getting delta using e^-qT * N(d1)
     auto norm_args = compute_norm_args_(vol);
     double d1 = norm_args[0];
     double nD1 = norm_cdf(d1);
+    double dividendFactor = std::exp(-dividend_yield_ * time_to_maturity_);
 
-    return (payoff_type_ == PayoffType::Call ? nD1 : nD1 - 1);
+    return dividendFactor * (payoff_type_ == PayoffType::Call ? nD1 : nD1 - 1);
 }
 
 double BlackScholes::get_gamma(double vol) const
 {
-    // getting gamma using N'(d1) / (S0*sigma*sqrt(T))
+    // getting gamma using e^-qT * N'(d1) / (S0*sigma*sqrt(T))
     auto norm_args = compute_norm_args_(vol);
     double d1 = norm_args[0];
     double nD1 = norm_pdf(d1);
+    double dividendFactor = std::exp(-dividend_yield_ * time_to_maturity_);
 
-    return nD1 / (spot_ * vol * ::sqrt(time_to_maturity_));
+    return dividendFactor * nD1 / (spot_ * vol * ::sqrt(time_to_maturity_));
 }
 
 double BlackScholes::get_vega(double vol) const
 {
-    // getting vega using N'(d1) * S0 * sqrt(T)
+    // getting vega using e^-qT * N'(d1) * S0 * sqrt(T)
     auto norma_args = compute_norm_args_(vol);
     double d1 = norma_args[0];
     double nD1 = norm_pdf(d1);
+    double dividendFactor = std::exp(-dividend_yield_ * time_to_maturity_);
 
-    return spot_ * std::sqrt(time_to_maturity_) * nD1;
+    return dividendFactor * spot_ * std::sqrt(time_to_maturity_) * nD1;
 }
 
 // overloading the << operator to display the content of the object using std::cout
@@ -90,5 +116,7 @@ std::ostream &operator<<(std::ostream &os, const BlackScholes &bs)
        << "  Interest Rate: " << bs.interest_rate_ << "\n"
        << "  Dividend Yield: " << bs.dividend_yield_ << "\n"
        << "  Payoff Type: " << (bs.payoff_type_ == PayoffType::Call ? "Call" : "Put") << "\n";
+    if (bs.early_exercise_ != EarlyExercise::None)
+        os << "  Early Exercise: " << (bs.early_exercise_ == EarlyExercise::BaroneAdesiWhaley ? "Barone-Adesi-Whaley" : "Bjerksund-Stensland") << "\n";
     return os;
 }
\ No newline at end of file
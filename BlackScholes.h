@@ -11,13 +11,32 @@ enum class PayoffType
     Put = -1
 };
 
+// early exercise approximation used by operator(), see American.h; None prices the European option
+enum class EarlyExercise
+{
+    None,
+    BaroneAdesiWhaley,
+    BjerksundStensland
+};
+
 // Blackscholes class
 class BlackScholes
 {
 public:
     BlackScholes(double strike, double spot, double time_to_maturity,
                  double interest_rate, PayoffType payoff_type, double dividend_yield = 0);
+    // Black-76 model of an option on a forward or future: the forward grows at the rate it is discounted at,
+    // so this is Black-Scholes on spot = forward with dividend yield = rate, and delta and gamma are per unit of forward
+    static BlackScholes black76(double strike, double forward, double time_to_maturity,
+                                double interest_rate, PayoffType payoff_type);
+    // the same contract priced as American with the given approximation
+    BlackScholes with_early_exercise(EarlyExercise early_exercise) const;
+    BlackScholes european() const { return with_early_exercise(EarlyExercise::None); }
+    // the same contract and exercise style at another spot, for bumped greeks
+    BlackScholes with_spot(double spot) const;
     double operator()(double vol) const;
+    // the analytic greeks are the European ones whatever the exercise style; they serve as the Newton
+    // slope and the reported greeks, the finite difference greeks do include the early exercise premium
     double get_delta(double vol) const;
     double get_gamma(double vol) const;
     double get_vega(double vol) const;
@@ -26,7 +45,9 @@ public:
     double get_strike() const { return strike_; }
     double get_time_to_maturity() const { return time_to_maturity_; }
     double get_interest_rate() const { return interest_rate_; }
+    double get_dividend_yield() const { return dividend_yield_; }
     PayoffType get_payoff_type() const { return payoff_type_; }
+    EarlyExercise get_early_exercise() const { return early_exercise_; }
 
 private:
     // member variables spot price, strike price, time to maturity,
@@ -34,6 +55,7 @@ private:
     double spot_, strike_, time_to_maturity_;
     double interest_rate_, dividend_yield_;
     PayoffType payoff_type_;
+    EarlyExercise early_exercise_ = EarlyExercise::None;
     std::array<double, 2> compute_norm_args_(double vol) const;
     friend std::ostream &operator<<(std::ostream &os, const BlackScholes &bs);
 };
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "CommandLine.h"
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+    // split a comma separated list and look every item up, returns false on an unknown item
+    template <typename Apply>
+    bool for_each_item(const std::string &list, Apply apply)
+    {
+        std::stringstream ss(list);
+        std::string item;
+        bool any = false;
+        while (std::getline(ss, item, ','))
+        {
+            if (!apply(item))
+                return false;
+            any = true;
+        }
+        return any;
+    }
+
+    bool parse_stages(const std::string &list, unsigned &stages)
+    {
+        static const std::unordered_map<std::string, unsigned> names = {
+            {"load", StageLoad}, {"parity", StageParity}, {"iv", StageIV}, {"greeks", StageGreeks},
+            {"reprice", StageReprice}, {"integrate", StageIntegrate}, {"all", StageAll}};
+        stages = StageLoad;
+        return for_each_item(list, [&stages](const std::string &name)
+                             {
+            auto it = names.find(name);
+            if (it == names.end())
+                return false;
+            stages |= it->second;
+            return true; });
+    }
+
+    bool parse_solvers(const std::string &list, IVSettings &iv)
+    {
+        iv.bisection = iv.newton = iv.secant = false;
+        return for_each_item(list, [&iv](const std::string &name)
+                             {
+            if (name == "bisection" || name == "all")
+                iv.bisection = true;
+            if (name == "newton" || name == "all")
+                iv.newton = true;
+            if (name == "secant" || name == "all")
+                iv.secant = true;
+            return name == "bisection" || name == "newton" || name == "secant" || name == "all"; });
+    }
+
+    bool parse_greek_methods(const std::string &list, IVSettings &iv)
+    {
+        iv.analyticGreeks = iv.finiteDifferenceGreeks = false;
+        return for_each_item(list, [&iv](const std::string &name)
+                             {
+            if (name == "analytic" || name == "all")
+                iv.analyticGreeks = true;
+            if (name == "fd" || name == "all")
+                iv.finiteDifferenceGreeks = true;
+            return name == "analytic" || name == "fd" || name == "all"; });
+    }
+
+    bool parse_early_exercise(const std::string &name, EarlyExercise &earlyExercise)
+    {
+        static const std::unordered_map<std::string, EarlyExercise> names = {
+            {"off", EarlyExercise::None}, {"baw", EarlyExercise::BaroneAdesiWhaley}, {"bs", EarlyExercise::BjerksundStensland}};
+        auto it = names.find(name);
+        if (it == names.end())
+            return false;
+        earlyExercise = it->second;
+        return true;
+    }
+
+    bool parse_count(const std::string &value, long &count)
+    {
+        try
+        {
+            size_t used = 0;
+            count = std::stol(value, &used);
+            return used == value.size() && count >= 0;
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+}
+
+std::string RunConfig::output_path(const std::string &name) const
+{
+    if (outputDir.empty())
+        return name;
+    return outputDir.back() == '/' ? outputDir + name : outputDir + "/" + name;
+}
+
+std::string RunConfig::chain_path(const std::string &ticker, const std::string &name) const
+{
+    return output_path(ticker + "_" + name + (format == "tsv" ? ".tsv" : ".csv"));
+}
+
+bool parse_command_line(int argc, char *argv[], RunConfig &config, std::string &error)
+{
+    // flags that take a value, each parses it into the config
+    const std::unordered_map<std::string, std::function<bool(const std::string &)>> flags = {
+        {"--input", [&](const std::string &v)
+         { config.input = v; return true; }},
+        {"--next-day", [&](const std::string &v)
+         { config.nextDayInput = v == "none" ? "" : v; return true; }},
+        {"--output-dir", [&](const std::string &v)
+         { config.outputDir = v; return true; }},
+        {"--stages", [&](const std::string &v)
+         { return parse_stages(v, config.stages); }},
+        {"--solver", [&](const std::string &v)
+         { return parse_solvers(v, config.iv); }},
+        {"--greeks", [&](const std::string &v)
+         { return parse_greek_methods(v, config.iv); }},
+        {"--american", [&](const std::string &v)
+         { return parse_early_exercise(v, config.iv.american); }},
+        {"--solver-times", [&](const std::string &v)
+         { config.iv.timing = v == "on"; return v == "on" || v == "off"; }},
+        {"--threads", [&](const std::string &v)
+         { long n; return parse_count(v, n) && (config.threads = static_cast<unsigned>(n), true); }},
+        {"--format", [&](const std::string &v)
+         { config.format = v; config.csv.delimiter = v == "tsv" ? '\t' : ','; return v == "csv" || v == "tsv" || v == "none"; }},
+        {"--precision", [&](const std::string &v)
+         { long n; return parse_count(v, n) && n <= 17 && (config.csv.precision = static_cast<int>(n), true); }},
+        {"--columns", [&](const std::string &v)
+         { return parse_csv_columns(v, config.csv.columns); }},
+        {"--cache", [&](const std::string &v)
+         { config.cachePath = v; return true; }},
+        {"--positions", [&](const std::string &v)
+         { config.positionsPath = v; return true; }},
+        {"--bench-solvers", [&](const std::string &v)
+         { long n; return parse_count(v, n) && (config.benchRepetitions = static_cast<int>(n), true); }},
+        {"--replay", [&](const std::string &v)
+         { config.replaySource = v; return true; }},
+        {"--compact", [&](const std::string &v)
+         { config.compact = v != "off"; config.compactDiagnostics = v == "diagnostics"; return v == "on" || v == "off" || v == "diagnostics"; }},
+        {"--consumers", [&](const std::string &v)
+         { long n; return parse_count(v, n) && n > 0 && (config.replayConsumers = static_cast<unsigned>(n), true); }},
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h")
+        {
+            config.help = true;
+            return true;
+        }
+        auto it = flags.find(flag);
+        if (it == flags.end())
+        {
+            error = "unknown option " + flag;
+            return false;
+        }
+        if (i + 1 >= argc)
+        {
+            error = "missing value for " + flag;
+            return false;
+        }
+        if (!it->second(argv[++i]))
+        {
+            error = "invalid value " + std::string(argv[i]) + " for " + flag;
+            return false;
+        }
+    }
+
+    // without the greeks stage the solvers run alone
+    if (!config.has(StageGreeks))
+    {
+        config.iv.analyticGreeks = config.iv.finiteDifferenceGreeks = false;
+    }
+    if (!config.has(StageIV) && (config.stages & (StageGreeks | StageReprice)))
+    {
+        error = "the greeks and reprice stages need the iv stage";
+        return false;
+    }
+    // the benchmark solves against the parity fits of the full chains, which compact chains do not keep
+    if (config.compact && config.benchRepetitions > 0)
+    {
+        error = "--bench-solvers needs the full chains, it cannot run with --compact";
+        return false;
+    }
+    // greeks are evaluated at the solved IV, so the iv stage needs at least one solver
+    if (config.has(StageIV) && !config.iv.bisection && !config.iv.newton && !config.iv.secant)
+    {
+        error = "the iv stage needs at least one solver";
+        return false;
+    }
+    return true;
+}
+
+void print_usage(std::ostream &os, const char *program)
+{
+    os << "usage: " << program << " [options]\n"
+       << "  --help                  print this message\n"
+       << "  --input <csv|dir>       option chains to solve, or a directory of per-expiration chain dumps\n"
+       << "                          (default options_data1.csv)\n"
+       << "  --next-day <csv|dir|none> chains repriced from the solved IVs (default options_data2.csv)\n"
+       << "  --output-dir <dir>      directory for the output files (default working directory)\n"
+       << "  --stages <list>         comma separated: load,parity,iv,greeks,reprice,integrate or all (default all)\n"
+       << "  --solver <list>         IV solvers: bisection,newton,secant or all (default all)\n"
+       << "  --greeks <list>         greek methods: analytic,fd or all (default all)\n"
+       << "  --american <off|baw|bs> solve equity chains as American options with the Barone-Adesi-Whaley or\n"
+       << "                          Bjerksund-Stensland approximation (default off)\n"
+       << "  --solver-times <on|off> per-contract solver timings in the chain files (default off)\n"
+       << "  --threads <n>           worker threads, 0 for the hardware concurrency (default 0)\n"
+       << "  --format <csv|tsv|none> chain file format, none writes no chain files (default csv)\n"
+       << "  --precision <digits>    significant digits, 0 for shortest round-trip (default 0)\n"
+       << "  --columns <list>        chain file columns by header name (default all)\n"
+       << "  --cache <path>          warm-start cache of solved IVs\n"
+       << "  --positions <csv>       book of positions to aggregate risk over\n"
+       << "  --bench-solvers <n>     compare the solvers over n timed passes, writes solver_report.csv\n"
+       << "  --compact <on|off|diagnostics> hold the chains in 56 byte float records, diagnostics also keeps\n"
+       << "                          the solver IVs and timings, fd greeks and parity residuals (default off)\n"
+       << "  --replay <src>          replay quote updates from a file or unix:<socket> on top of --input\n"
+       << "  --consumers <n>         consumer threads of the replay (default hardware concurrency - 1)\n";
+}
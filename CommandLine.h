@@ -0,0 +1,50 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include "CsvWriter.h"
+#include "OptionData.h"
+
+// pipeline stages of the main driver, a run only pays for the stages it selects
+enum Stage : unsigned
+{
+    StageLoad = 1,       // read the chains (always runs)
+    StageParity = 2,     // put-call parity fits, the implied forwards the IVs are solved against
+    StageIV = 4,         // implied vols with the selected solvers
+    StageGreeks = 8,     // greeks with the selected methods, needs iv
+    StageReprice = 16,   // local vol and Heston repricing, and next-day pricing from today's IVs, needs iv
+    StageIntegrate = 32, // numerical integration demos
+    StageAll = 63
+};
+
+// everything the main driver takes from the command line
+struct RunConfig
+{
+    std::string input = "options_data1.csv";        // chains to solve
+    std::string nextDayInput = "options_data2.csv"; // chains repriced from the solved IVs, empty to skip
+    std::string outputDir;                           // directory the output files are written to, empty for the working directory
+    unsigned stages = StageAll;
+    IVSettings iv;
+    unsigned threads = 0;        // worker threads of the parallel stages, 0 for the hardware concurrency
+    std::string format = "csv";  // csv, tsv or none for the per-ticker chain files
+    CsvOptions csv;
+
+    std::string cachePath;     // warm-start cache of solved IVs
+    std::string positionsPath; // book of positions to aggregate risk over
+    int benchRepetitions = 0;  // timed passes of the solver benchmark, 0 to skip it
+    std::string replaySource;  // replay quote updates from this file or unix:socket instead of the pipeline
+    unsigned replayConsumers = 0;
+    bool compact = false;            // hold the chains as CompactChain records and expand one ticker at a time
+    bool compactDiagnostics = false; // keep the diagnostic side table in the compact chains
+    bool help = false;
+
+    bool has(Stage stage) const { return (stages & stage) != 0; }
+    // path of an output file in the output directory
+    std::string output_path(const std::string &name) const;
+    // path of a per-ticker chain file, e.g. SPY_outputData1.csv, with the extension of the format
+    std::string chain_path(const std::string &ticker, const std::string &name) const;
+};
+
+// parse the arguments into config, returns false and sets error on an unknown flag or value
+bool parse_command_line(int argc, char *argv[], RunConfig &config, std::string &error);
+
+void print_usage(std::ostream &os, const char *program);
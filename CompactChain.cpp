@@ -0,0 +1,231 @@
+#include "CompactChain.h"
+#include "Ticker.h"
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    // the double a quote was read as: the shortest decimal that rounds to the float, parsed as a double,
+    // so quotes with up to 7 significant digits (every cent price below 100000) expand to the exact input
+    double widen(float value)
+    {
+        char text[32];
+        auto end = std::to_chars(text, text + sizeof(text), value).ptr;
+        double result = value;
+        std::from_chars(text, end, result);
+        return result;
+    }
+}
+
+CompactChain::CompactChain(const std::string &name, double spot, double rate, bool diagnostics)
+    : name_(name), spot_(spot), rate_(rate), keepDiagnostics_(diagnostics) {}
+
+CompactChain CompactChain::from_ticker(const Ticker &ticker, bool diagnostics)
+{
+    CompactChain chain(ticker.getTickerName(), ticker.getSpotPrice(), ticker.getInterestRate(), diagnostics);
+    const auto &options = ticker.getOptions();
+    chain.records_.reserve(options.size());
+    for (const auto &option : options)
+    {
+        chain.add(option->expiration, option->timeToMaturity, option->strike, option->optionType != "Call",
+                  option->lastPrice, option->bid, option->ask, option->volume, option->openInterest,
+                  option->impliedVolatility, option->inTheMoney);
+        chain.store(chain.records_.size() - 1, *option);
+    }
+    chain.finish();
+    return chain;
+}
+
+uint16_t CompactChain::expiry_id(const std::string &expiration, double timeToMaturity)
+{
+    // quotes come grouped by expiration, so the last one added is almost always the match
+    for (size_t i = expiries_.size(); i-- > 0;)
+    {
+        if (expiries_[i].expiration == expiration)
+            return static_cast<uint16_t>(i);
+    }
+    if (expiries_.size() > std::numeric_limits<uint16_t>::max())
+    {
+        throw std::length_error("more than 65536 expirations in the chain of " + name_);
+    }
+    expiries_.push_back({expiration, timeToMaturity});
+    return static_cast<uint16_t>(expiries_.size() - 1);
+}
+
+void CompactChain::add(const std::string &expiration, double timeToMaturity, double strike, bool put, double lastPrice,
+                       double bid, double ask, double volume, double openInterest, double impliedVolatility, bool inTheMoney)
+{
+    CompactContract record{};
+    record.strike = static_cast<float>(strike);
+    record.lastPrice = static_cast<float>(lastPrice);
+    record.bid = static_cast<float>(bid);
+    record.ask = static_cast<float>(ask);
+    record.volume = static_cast<float>(volume);
+    record.openInterest = static_cast<float>(openInterest);
+    record.impliedVolatility = static_cast<float>(impliedVolatility);
+    record.expiry = expiry_id(expiration, timeToMaturity);
+    record.flags = static_cast<uint8_t>((put ? CompactContract::Put : 0) | (inTheMoney ? CompactContract::InTheMoney : 0));
+    records_.push_back(record);
+    if (keepDiagnostics_)
+    {
+        diagnostics_.push_back({});
+    }
+}
+
+void CompactChain::finish()
+{
+    // expirations in ISO date order, the order Ticker::build_slices puts them in
+    std::vector<uint16_t> order(expiries_.size());
+    std::iota(order.begin(), order.end(), uint16_t{0});
+    std::sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b)
+              { return expiries_[a].expiration < expiries_[b].expiration; });
+    std::vector<uint16_t> rank(expiries_.size());
+    std::vector<Expiry> sorted;
+    sorted.reserve(expiries_.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        rank[order[i]] = static_cast<uint16_t>(i);
+        sorted.push_back(std::move(expiries_[order[i]]));
+    }
+    expiries_ = std::move(sorted);
+    for (CompactContract &record : records_)
+    {
+        record.expiry = rank[record.expiry];
+    }
+
+    // then calls before puts and by strike, duplicates keep their input order like build_slices
+    std::vector<size_t> index(records_.size());
+    std::iota(index.begin(), index.end(), size_t{0});
+    std::stable_sort(index.begin(), index.end(), [this](size_t a, size_t b)
+                     {
+        const CompactContract &x = records_[a], &y = records_[b];
+        if (x.expiry != y.expiry)
+            return x.expiry < y.expiry;
+        if (x.is_put() != y.is_put())
+            return y.is_put();
+        return x.strike < y.strike; });
+
+    std::vector<CompactContract> records(records_.size());
+    std::vector<CompactDiagnostics> diagnostics(diagnostics_.size());
+    for (size_t i = 0; i < index.size(); ++i)
+    {
+        records[i] = records_[index[i]];
+        if (keepDiagnostics_)
+            diagnostics[i] = diagnostics_[index[i]];
+    }
+    records_ = std::move(records);
+    diagnostics_ = std::move(diagnostics);
+    expiries_.shrink_to_fit();
+}
+
+OptionData CompactChain::expand(size_t index) const
+{
+    const CompactContract &record = records_[index];
+    const Expiry &expiry = expiries_[record.expiry];
+    OptionData option(expiry.expiration, expiry.timeToMaturity, widen(record.strike), record.is_put() ? "Put" : "Call",
+                      widen(record.lastPrice), widen(record.bid), widen(record.ask), widen(record.volume),
+                      widen(record.openInterest), widen(record.impliedVolatility), record.flags & CompactContract::InTheMoney);
+    option.delta_bs = record.delta;
+    option.gamma_bs = record.gamma;
+    option.vega_bs = record.vega;
+    option.parity_price = record.parityPrice;
+    option.bs_price = record.bsPrice;
+
+    if (keepDiagnostics_)
+    {
+        const CompactDiagnostics &d = diagnostics_[index];
+        option.bisectionImpliedVol = d.bisectionImpliedVol;
+        option.newtonImpliedVol = d.newtonImpliedVol;
+        option.secantImpliedVol = d.secantImpliedVol;
+        option.bisectionTime = d.bisectionTime;
+        option.newtonTime = d.newtonTime;
+        option.secantTime = d.secantTime;
+        option.delta_fd = d.delta_fd;
+        option.gamma_fd = d.gamma_fd;
+        option.vega_fd = d.vega_fd;
+        option.parity_residual = d.parity_residual;
+        return option;
+    }
+
+    // without the side table only the IV that implied_vol() picks is kept, in the slot it came from
+    switch (record.solver())
+    {
+    case CompactContract::Bisection:
+        option.bisectionImpliedVol = record.vol;
+        break;
+    case CompactContract::Newton:
+        option.newtonImpliedVol = record.vol;
+        break;
+    case CompactContract::Secant:
+        option.secantImpliedVol = record.vol;
+        break;
+    case CompactContract::NoSolver:
+        break;
+    }
+    return option;
+}
+
+std::unique_ptr<Ticker> CompactChain::to_ticker() const
+{
+    auto ticker = std::make_unique<Ticker>(name_, spot_, rate_);
+    for (size_t i = 0; i < records_.size(); ++i)
+    {
+        ticker->addOptionData(std::make_unique<OptionData>(expand(i)));
+    }
+    // the records are in chain order already, so this only builds the slice directory
+    ticker->build_slices();
+    return ticker;
+}
+
+void CompactChain::store(size_t index, const OptionData &option)
+{
+    CompactContract &record = records_[index];
+    double vol = option.implied_vol();
+    CompactContract::Solver solver = option.bisectionImpliedVol > 0 ? CompactContract::Bisection
+                                     : option.newtonImpliedVol > 0  ? CompactContract::Newton
+                                     : option.secantImpliedVol > 0  ? CompactContract::Secant
+                                                                    : CompactContract::NoSolver;
+    record.vol = static_cast<float>(vol);
+    record.flags = static_cast<uint8_t>((record.flags & ~CompactContract::SolverMask) | (solver << CompactContract::SolverShift));
+    record.impliedVolatility = static_cast<float>(option.impliedVolatility);
+    record.delta = static_cast<float>(option.delta_bs);
+    record.gamma = static_cast<float>(option.gamma_bs);
+    record.vega = static_cast<float>(option.vega_bs);
+    record.parityPrice = static_cast<float>(option.parity_price);
+    record.bsPrice = static_cast<float>(option.bs_price);
+
+    if (keepDiagnostics_)
+    {
+        diagnostics_[index] = {option.bisectionImpliedVol, option.newtonImpliedVol, option.secantImpliedVol,
+                               option.bisectionTime, option.newtonTime, option.secantTime,
+                               option.delta_fd, option.gamma_fd, option.vega_fd, option.parity_residual};
+    }
+}
+
+bool CompactChain::store_results(const Ticker &ticker)
+{
+    const auto &options = ticker.getOptions();
+    if (ticker.getTickerName() != name_ || options.size() != records_.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        store(i, *options[i]);
+    }
+    return true;
+}
+
+size_t CompactChain::memory_bytes() const
+{
+    size_t bytes = sizeof(*this) + records_.capacity() * sizeof(CompactContract) +
+                   diagnostics_.capacity() * sizeof(CompactDiagnostics) + expiries_.capacity() * sizeof(Expiry);
+    for (const Expiry &expiry : expiries_)
+    {
+        bytes += expiry.expiration.capacity() > 15 ? expiry.expiration.capacity() + 1 : 0; // beyond the SSO buffer
+    }
+    return bytes;
+}
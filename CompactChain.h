@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "OptionData.h"
+
+class Ticker;
+
+// 56 byte record of one contract in a CompactChain, against the ~310 bytes of an OptionData behind a
+// unique_ptr (27 doubles, two heap strings and the allocation itself)
+//
+// accuracy: every float is the double rounded to nearest (relative error 2^-24); quotes expand to the
+// shortest decimal that rounds to the float, which is within 2^-23 (1.2e-7) of the input
+// - strike, last, bid and ask with up to 7 significant digits (any cent price below 100000) expand exactly
+// - volume and open interest are exact below 2^24 (16.7M contracts)
+// - implied vols up to 3 (the bisection bracket) are within 1.8e-7, far inside the 1e-4 IV tolerance of
+//   the regression suite; delta, gamma, vega and the prices keep 7 significant digits
+// time to maturity and the expiration string stay exact in the chain's expiry table
+struct CompactContract
+{
+    enum Flags : uint8_t
+    {
+        Put = 1,
+        InTheMoney = 2,
+        SolverMask = 12 // which Solver the stored vol came from (OptionData::implied_vol)
+    };
+    static constexpr int SolverShift = 2;
+    enum Solver : uint8_t
+    {
+        NoSolver,
+        Bisection,
+        Newton,
+        Secant
+    };
+
+    float strike;
+    float lastPrice, bid, ask;
+    float volume, openInterest;
+    float impliedVolatility; // the quoted IV of the input file
+    float vol;               // the solved IV the greeks and downstream models use
+    float delta, gamma, vega;
+    float parityPrice, bsPrice;
+    uint16_t expiry; // index into the expiry table of the chain
+    uint8_t flags;
+
+    bool is_put() const { return flags & Put; }
+    Solver solver() const { return static_cast<Solver>((flags & SolverMask) >> SolverShift); }
+};
+static_assert(sizeof(CompactContract) == 56, "CompactContract should stay at 56 bytes");
+
+// the rarely read per-contract outputs: the individual solver IVs and timings, the finite difference
+// greeks and the parity residual, kept in double only when the chain is built with diagnostics
+struct CompactDiagnostics
+{
+    double bisectionImpliedVol, newtonImpliedVol, secantImpliedVol;
+    double bisectionTime, newtonTime, secantTime;
+    double delta_fd, gamma_fd, vega_fd;
+    double parity_residual;
+};
+
+// memory-lean option chain of one ticker: CompactContract records in chain order (expiration, then calls
+// and puts by strike) with a shared expiry table; chains are expanded into a Ticker one at a time for
+// the solvers and the results are folded back, so a whole universe stays resident at ~56 bytes a contract
+class CompactChain
+{
+public:
+    struct Expiry
+    {
+        std::string expiration;
+        double timeToMaturity;
+    };
+
+    CompactChain(const std::string &name, double spot, double rate, bool diagnostics = false);
+
+    // compact copy of a ticker's chain and its results
+    static CompactChain from_ticker(const Ticker &ticker, bool diagnostics = false);
+
+    // append a quote; contracts may come in any order, finish() restores the chain order
+    void add(const std::string &expiration, double timeToMaturity, double strike, bool put, double lastPrice,
+             double bid, double ask, double volume, double openInterest, double impliedVolatility, bool inTheMoney);
+    // sort the expiry table and the records into chain order and release spare capacity
+    void finish();
+
+    // a full Ticker with every contract and stored result expanded into an OptionData
+    std::unique_ptr<Ticker> to_ticker() const;
+    // fold the solved IVs, greeks and prices of a ticker expanded by to_ticker back into the records;
+    // returns false if the chain does not match
+    bool store_results(const Ticker &ticker);
+    // one contract as an OptionData, the diagnostic fields are 0 when the chain keeps none
+    OptionData expand(size_t index) const;
+
+    const std::string &name() const { return name_; }
+    double spot() const { return spot_; }
+    double rate() const { return rate_; }
+    size_t size() const { return records_.size(); }
+    const std::vector<CompactContract> &records() const { return records_; }
+    const std::vector<Expiry> &expiries() const { return expiries_; }
+    bool has_diagnostics() const { return keepDiagnostics_; }
+    // bytes held by the records, the expiry table and the side table
+    size_t memory_bytes() const;
+
+private:
+    std::string name_;
+    double spot_, rate_;
+    bool keepDiagnostics_;
+    std::vector<Expiry> expiries_;
+    std::vector<CompactContract> records_;
+    std::vector<CompactDiagnostics> diagnostics_; // parallel to records_ when keepDiagnostics_
+
+    uint16_t expiry_id(const std::string &expiration, double timeToMaturity);
+    void store(size_t index, const OptionData &option);
+};
@@ -0,0 +1,193 @@
+#include "CsvWriter.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr const char *column_names[] = {
+        "Ticker", "Expiration", "TimeToMaturity", "Strike", "OptionType", "LastPrice",
+        "Bid", "Ask", "Volume", "OpenInterest", "ImpliedVolatility", "BisectionIV", "BisectionTime", "NewtonIV", "NewtonTime",
+        "SecantIV", "SecantTime", "Delta_bs", "Gamma_bs", "Vega_bs", "Delta_fd", "Gamma_fd", "Vega_fd", "Parity_price", "Bs_price", "InTheMoney"};
+    static_assert(std::size(column_names) == static_cast<size_t>(CsvColumn::Count));
+
+    // appends formatted fields to a chunk buffer
+    class RowEncoder
+    {
+    public:
+        RowEncoder(std::string &out, int precision) : out_(out), precision_(std::min(precision, 17)) {}
+
+        void text(const std::string &value) { out_.append(value); }
+        void text(const char *value) { out_.append(value); }
+
+        void number(double value)
+        {
+            char buffer[64];
+            std::to_chars_result result = precision_ > 0
+                                              ? std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision_)
+                                              : std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out_.append(buffer, result.ptr);
+        }
+
+    private:
+        std::string &out_;
+        int precision_;
+    };
+
+    void encode_field(RowEncoder &row, CsvColumn column, const std::string &tickerName, const OptionData &option)
+    {
+        switch (column)
+        {
+        case CsvColumn::Ticker: row.text(tickerName); break;
+        case CsvColumn::Expiration: row.text(option.expiration); break;
+        case CsvColumn::TimeToMaturity: row.number(option.timeToMaturity); break;
+        case CsvColumn::Strike: row.number(option.strike); break;
+        case CsvColumn::OptionType: row.text(option.optionType); break;
+        case CsvColumn::LastPrice: row.number(option.lastPrice); break;
+        case CsvColumn::Bid: row.number(option.bid); break;
+        case CsvColumn::Ask: row.number(option.ask); break;
+        case CsvColumn::Volume: row.number(option.volume); break;
+        case CsvColumn::OpenInterest: row.number(option.openInterest); break;
+        case CsvColumn::ImpliedVolatility: row.number(option.impliedVolatility); break;
+        case CsvColumn::BisectionIV: row.number(option.bisectionImpliedVol); break;
+        case CsvColumn::BisectionTime: row.number(option.bisectionTime); break;
+        case CsvColumn::NewtonIV: row.number(option.newtonImpliedVol); break;
+        case CsvColumn::NewtonTime: row.number(option.newtonTime); break;
+        case CsvColumn::SecantIV: row.number(option.secantImpliedVol); break;
+        case CsvColumn::SecantTime: row.number(option.secantTime); break;
+        case CsvColumn::Delta_bs: row.number(option.delta_bs); break;
+        case CsvColumn::Gamma_bs: row.number(option.gamma_bs); break;
+        case CsvColumn::Vega_bs: row.number(option.vega_bs); break;
+        case CsvColumn::Delta_fd: row.number(option.delta_fd); break;
+        case CsvColumn::Gamma_fd: row.number(option.gamma_fd); break;
+        case CsvColumn::Vega_fd: row.number(option.vega_fd); break;
+        case CsvColumn::Parity_price: row.number(option.parity_price); break;
+        case CsvColumn::Bs_price: row.number(option.bs_price); break;
+        case CsvColumn::InTheMoney: row.text(option.inTheMoney ? "True" : "False"); break;
+        case CsvColumn::Count: break;
+        }
+    }
+
+    // write the whole buffer, retrying on short writes
+    bool write_all(int fd, const std::string &buffer)
+    {
+        const char *data = buffer.data();
+        size_t remaining = buffer.size();
+        while (remaining > 0)
+        {
+            ssize_t written = ::write(fd, data, remaining);
+            if (written < 0)
+            {
+                return false;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+}
+
+const char *csv_column_name(CsvColumn column)
+{
+    return column_names[static_cast<size_t>(column)];
+}
+
+bool parse_csv_columns(const std::string &list, std::vector<CsvColumn> &columns)
+{
+    columns.clear();
+    size_t begin = 0;
+    while (begin <= list.size())
+    {
+        size_t end = std::min(list.find(',', begin), list.size());
+        std::string name = list.substr(begin, end - begin);
+        auto it = std::find_if(std::begin(column_names), std::end(column_names),
+                               [&name](const char *column)
+                               { return name == column; });
+        if (it == std::end(column_names))
+        {
+            return false;
+        }
+        columns.push_back(static_cast<CsvColumn>(it - std::begin(column_names)));
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool write_options_csv(const std::string &filename, const std::string &tickerName,
+                       const std::vector<std::unique_ptr<OptionData>> &options, const CsvOptions &csvOptions)
+{
+    std::vector<CsvColumn> columns = csvOptions.columns;
+    if (columns.empty())
+    {
+        for (size_t c = 0; c < static_cast<size_t>(CsvColumn::Count); ++c)
+        {
+            columns.push_back(static_cast<CsvColumn>(c));
+        }
+    }
+
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Unable to open file " << filename << std::endl;
+        return false;
+    }
+
+    // **Write CSV Header**
+    std::string header;
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+        if (c)
+            header.push_back(csvOptions.delimiter);
+        header.append(csv_column_name(columns[c]));
+    }
+    header.push_back('\n');
+    bool ok = write_all(fd, header);
+
+    // **Write Option Data** in waves of chunks: encode a wave in parallel, then write it in order
+    size_t rowsPerChunk = std::max<size_t>(csvOptions.rowsPerChunk, 1);
+    size_t numChunks = (options.size() + rowsPerChunk - 1) / rowsPerChunk;
+    size_t chunksPerWave = 2 * static_cast<size_t>(parallel_threads());
+    std::vector<std::string> buffers(std::min(numChunks, chunksPerWave));
+
+    for (size_t wave = 0; ok && wave < numChunks; wave += chunksPerWave)
+    {
+        size_t waveChunks = std::min(chunksPerWave, numChunks - wave);
+        parallel_for(waveChunks, [&](size_t begin, size_t end)
+                     {
+            for (size_t b = begin; b < end; ++b)
+            {
+                std::string &buffer = buffers[b];
+                buffer.clear();
+                RowEncoder row(buffer, csvOptions.precision);
+
+                size_t first = (wave + b) * rowsPerChunk;
+                size_t last = std::min(first + rowsPerChunk, options.size());
+                for (size_t i = first; i < last; ++i)
+                {
+                    for (size_t c = 0; c < columns.size(); ++c)
+                    {
+                        if (c)
+                            buffer.push_back(csvOptions.delimiter);
+                        encode_field(row, columns[c], tickerName, *options[i]);
+                    }
+                    buffer.push_back('\n');
+                }
+            } });
+
+        for (size_t b = 0; ok && b < waveChunks; ++b)
+        {
+            ok = write_all(fd, buffers[b]);
+        }
+    }
+
+    ok = (::close(fd) == 0) && ok;
+    if (!ok)
+    {
+        std::cerr << "Error: Unable to write file " << filename << std::endl;
+    }
+    return ok;
+}
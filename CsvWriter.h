@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "OptionData.h"
+
+// columns of the option chain csv, in the order of the full header
+enum class CsvColumn
+{
+    Ticker,
+    Expiration,
+    TimeToMaturity,
+    Strike,
+    OptionType,
+    LastPrice,
+    Bid,
+    Ask,
+    Volume,
+    OpenInterest,
+    ImpliedVolatility,
+    BisectionIV,
+    BisectionTime,
+    NewtonIV,
+    NewtonTime,
+    SecantIV,
+    SecantTime,
+    Delta_bs,
+    Gamma_bs,
+    Vega_bs,
+    Delta_fd,
+    Gamma_fd,
+    Vega_fd,
+    Parity_price,
+    Bs_price,
+    InTheMoney,
+    Count
+};
+
+struct CsvOptions
+{
+    // significant digits of floating point fields, 0 writes the shortest text that round-trips exactly;
+    // 6 reproduces the default ostream formatting
+    int precision = 0;
+    // columns to write, empty writes every column in header order
+    std::vector<CsvColumn> columns;
+    // field separator, '\t' writes tab separated files
+    char delimiter = ',';
+    // rows encoded per chunk, each chunk is encoded on a worker thread and written with one write call
+    size_t rowsPerChunk = 4096;
+};
+
+// header name of a column, e.g. "BisectionIV"
+const char *csv_column_name(CsvColumn column);
+
+// parse a comma separated list of header names, returns false on an unknown name
+bool parse_csv_columns(const std::string &list, std::vector<CsvColumn> &columns);
+
+// write the option chain of a ticker, returns false if the file could not be written
+bool write_options_csv(const std::string &filename, const std::string &tickerName,
+                       const std::vector<std::unique_ptr<OptionData>> &options, const CsvOptions &csvOptions = {});
@@ -0,0 +1,607 @@
+#include "DumpLoader.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    // one contract of a dump, before it becomes an OptionData
+    struct DumpQuote
+    {
+        double strike, lastPrice, bid, ask, volume, openInterest, impliedVolatility;
+        bool put, inTheMoney;
+    };
+
+    // the contracts of one dump file, sorted by type and strike
+    struct DumpRun
+    {
+        std::string ticker, expiration;
+        std::vector<DumpQuote> quotes;
+    };
+
+    struct MarketData
+    {
+        double spotPrice, interestRate;
+        std::chrono::sys_days asOf;
+    };
+
+    bool parse_date(const std::string &text, std::chrono::sys_days &date)
+    {
+        int y;
+        unsigned m, d;
+        char dash1, dash2;
+        std::istringstream ss(text);
+        if (!(ss >> y >> dash1 >> m >> dash2 >> d) || dash1 != '-' || dash2 != '-')
+            return false;
+        std::chrono::year_month_day ymd{std::chrono::year{y}, std::chrono::month{m}, std::chrono::day{d}};
+        if (!ymd.ok())
+            return false;
+        date = std::chrono::sys_days{ymd};
+        return true;
+    }
+
+    std::vector<std::string> split_csv_line(const std::string &line)
+    {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (!line.empty() && line.back() == ',')
+        {
+            fields.emplace_back();
+        }
+        return fields;
+    }
+
+    double parse_number(const std::string &text)
+    {
+        return text.empty() ? 0.0 : std::stod(text);
+    }
+
+    // market.csv: ticker,spotPrice,interestRate,asOf
+    std::unordered_map<std::string, MarketData> read_market_file(const std::string &fileName)
+    {
+        std::unordered_map<std::string, MarketData> market;
+        std::ifstream ifile(fileName);
+        if (!ifile.is_open())
+        {
+            std::cout << "Error opening " << fileName << ", the dump directory needs the spot and rate of every ticker" << std::endl;
+            return market;
+        }
+        std::string line;
+        std::getline(ifile, line);
+        while (std::getline(ifile, line))
+        {
+            std::vector<std::string> fields = split_csv_line(line);
+            MarketData data;
+            if (fields.size() < 4 || !parse_date(fields[3], data.asOf))
+            {
+                std::cout << "Error: skipping market data row " << line << std::endl;
+                continue;
+            }
+            try
+            {
+                data.spotPrice = std::stod(fields[1]);
+                data.interestRate = std::stod(fields[2]) / 100;
+            }
+            catch (const std::exception &)
+            {
+                std::cout << "Error: skipping market data row " << line << std::endl;
+                continue;
+            }
+            market[fields[0]] = data;
+        }
+        return market;
+    }
+
+    // **Minimal JSON reader**, enough for the Yahoo options response: objects, arrays, strings, numbers,
+    // booleans and null
+    struct JsonValue
+    {
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0;
+        std::string text;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        const JsonValue *find(std::string_view key) const
+        {
+            for (const auto &[name, value] : members)
+            {
+                if (name == key)
+                    return &value;
+            }
+            return nullptr;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(std::string_view input) : input_(input) {}
+
+        JsonValue parse()
+        {
+            JsonValue value = parse_value();
+            skip_space();
+            if (pos_ != input_.size())
+                fail("trailing characters");
+            return value;
+        }
+
+    private:
+        std::string_view input_;
+        size_t pos_ = 0;
+
+        [[noreturn]] void fail(const char *what) const
+        {
+            throw std::runtime_error(std::string("invalid JSON at offset ") + std::to_string(pos_) + ": " + what);
+        }
+
+        void skip_space()
+        {
+            while (pos_ < input_.size() && std::isspace(static_cast<unsigned char>(input_[pos_])))
+                pos_++;
+        }
+
+        bool consume(char c)
+        {
+            skip_space();
+            if (pos_ < input_.size() && input_[pos_] == c)
+            {
+                pos_++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!consume(c))
+                fail("unexpected character");
+        }
+
+        bool literal(std::string_view word)
+        {
+            if (input_.substr(pos_, word.size()) != word)
+                return false;
+            pos_ += word.size();
+            return true;
+        }
+
+        JsonValue parse_value()
+        {
+            skip_space();
+            if (pos_ >= input_.size())
+                fail("unexpected end");
+            JsonValue value;
+            char c = input_[pos_];
+            if (c == '{')
+            {
+                value.type = JsonValue::Type::Object;
+                pos_++;
+                if (consume('}'))
+                    return value;
+                do
+                {
+                    skip_space();
+                    std::string key = parse_string();
+                    expect(':');
+                    value.members.emplace_back(std::move(key), parse_value());
+                } while (consume(','));
+                expect('}');
+            }
+            else if (c == '[')
+            {
+                value.type = JsonValue::Type::Array;
+                pos_++;
+                if (consume(']'))
+                    return value;
+                do
+                {
+                    value.items.push_back(parse_value());
+                } while (consume(','));
+                expect(']');
+            }
+            else if (c == '"')
+            {
+                value.type = JsonValue::Type::String;
+                value.text = parse_string();
+            }
+            else if (literal("true") || literal("false"))
+            {
+                value.type = JsonValue::Type::Bool;
+                value.boolean = c == 't';
+            }
+            else if (literal("null"))
+            {
+                value.type = JsonValue::Type::Null;
+            }
+            else
+            {
+                value.type = JsonValue::Type::Number;
+                size_t start = pos_;
+                while (pos_ < input_.size() && (std::isdigit(static_cast<unsigned char>(input_[pos_])) ||
+                                                std::string_view("+-.eE").find(input_[pos_]) != std::string_view::npos))
+                    pos_++;
+                if (start == pos_)
+                    fail("unexpected character");
+                value.number = std::stod(std::string(input_.substr(start, pos_ - start)));
+            }
+            return value;
+        }
+
+        std::string parse_string()
+        {
+            if (pos_ >= input_.size() || input_[pos_] != '"')
+                fail("expected a string");
+            pos_++;
+            std::string text;
+            while (pos_ < input_.size() && input_[pos_] != '"')
+            {
+                char c = input_[pos_++];
+                if (c != '\\')
+                {
+                    text += c;
+                    continue;
+                }
+                if (pos_ >= input_.size())
+                    fail("unexpected end");
+                char escape = input_[pos_++];
+                switch (escape)
+                {
+                case 'b':
+                    text += '\b';
+                    break;
+                case 'f':
+                    text += '\f';
+                    break;
+                case 'n':
+                    text += '\n';
+                    break;
+                case 'r':
+                    text += '\r';
+                    break;
+                case 't':
+                    text += '\t';
+                    break;
+                case 'u':
+                {
+                    // symbols and expirations are ASCII, keep anything else as UTF-8 of the BMP code point
+                    if (pos_ + 4 > input_.size())
+                        fail("unexpected end");
+                    unsigned code = std::stoul(std::string(input_.substr(pos_, 4)), nullptr, 16);
+                    pos_ += 4;
+                    if (code < 0x80)
+                        text += static_cast<char>(code);
+                    else if (code < 0x800)
+                        text += {static_cast<char>(0xC0 | code >> 6), static_cast<char>(0x80 | (code & 0x3F))};
+                    else
+                        text += {static_cast<char>(0xE0 | code >> 12), static_cast<char>(0x80 | (code >> 6 & 0x3F)),
+                                 static_cast<char>(0x80 | (code & 0x3F))};
+                    break;
+                }
+                default:
+                    text += escape;
+                }
+            }
+            if (pos_ >= input_.size())
+                fail("unterminated string");
+            pos_++;
+            return text;
+        }
+    };
+
+    // a numeric field of a contract; the formatted Yahoo responses wrap numbers as {"raw": x, "fmt": "..."}
+    double json_number(const JsonValue &contract, std::string_view key)
+    {
+        const JsonValue *value = contract.find(key);
+        if (value && value->type == JsonValue::Type::Object)
+            value = value->find("raw");
+        return value && value->type == JsonValue::Type::Number ? value->number : 0.0;
+    }
+
+    // the first object holding a calls or puts array, wherever the response nests it
+    const JsonValue *find_chain(const JsonValue &value)
+    {
+        if (value.type == JsonValue::Type::Object && (value.find("calls") || value.find("puts")))
+            return &value;
+        for (const auto &item : value.items)
+        {
+            if (const JsonValue *chain = find_chain(item))
+                return chain;
+        }
+        for (const auto &[name, member] : value.members)
+        {
+            if (const JsonValue *chain = find_chain(member))
+                return chain;
+        }
+        return nullptr;
+    }
+
+    void read_json_dump(const std::string &fileName, DumpRun &run)
+    {
+        std::ifstream ifile(fileName, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(ifile)), std::istreambuf_iterator<char>());
+        JsonValue root = JsonParser(content).parse();
+        const JsonValue *chain = find_chain(root);
+        if (!chain)
+            throw std::runtime_error("no calls or puts in " + fileName);
+
+        for (bool put : {false, true})
+        {
+            const JsonValue *contracts = chain->find(put ? "puts" : "calls");
+            if (!contracts)
+                continue;
+            for (const JsonValue &contract : contracts->items)
+            {
+                const JsonValue *itm = contract.find("inTheMoney");
+                run.quotes.push_back({json_number(contract, "strike"), json_number(contract, "lastPrice"),
+                                      json_number(contract, "bid"), json_number(contract, "ask"),
+                                      json_number(contract, "volume"), json_number(contract, "openInterest"),
+                                      json_number(contract, "impliedVolatility"), put, itm && itm->boolean});
+            }
+        }
+    }
+
+    // a yfinance calls or puts DataFrame written with to_csv, columns are found by header name
+    void read_csv_dump(const std::string &fileName, bool put, DumpRun &run)
+    {
+        std::ifstream ifile(fileName);
+        std::string line;
+        if (!std::getline(ifile, line))
+            throw std::runtime_error("empty dump " + fileName);
+        std::vector<std::string> header = split_csv_line(line);
+        auto column = [&header, &fileName](const char *name)
+        {
+            auto it = std::find(header.begin(), header.end(), name);
+            if (it == header.end())
+                throw std::runtime_error(std::string("no ") + name + " column in " + fileName);
+            return static_cast<size_t>(it - header.begin());
+        };
+        size_t strike = column("strike"), lastPrice = column("lastPrice"), bid = column("bid"), ask = column("ask"),
+               volume = column("volume"), openInterest = column("openInterest"),
+               impliedVolatility = column("impliedVolatility"), inTheMoney = column("inTheMoney");
+
+        while (std::getline(ifile, line))
+        {
+            std::vector<std::string> fields = split_csv_line(line);
+            if (fields.size() < header.size())
+                continue;
+            run.quotes.push_back({parse_number(fields[strike]), parse_number(fields[lastPrice]), parse_number(fields[bid]),
+                                  parse_number(fields[ask]), parse_number(fields[volume]), parse_number(fields[openInterest]),
+                                  parse_number(fields[impliedVolatility]), put, fields[inTheMoney] == "True"});
+        }
+    }
+
+    // <ticker>_<YYYY-MM-DD>[_calls|_puts]: the ticker may hold underscores, the date is the last 10 characters
+    bool parse_dump_name(const std::filesystem::path &path, DumpRun &run, int &side)
+    {
+        std::string stem = path.stem().string();
+        side = 0;
+        if (path.extension() == ".csv" && stem.ends_with("_calls"))
+            side = 1;
+        else if (path.extension() == ".csv" && stem.ends_with("_puts"))
+            side = 2;
+        else if (path.extension() != ".json")
+            return false;
+        if (side)
+            stem = stem.substr(0, stem.rfind('_'));
+
+        std::chrono::sys_days date;
+        if (stem.size() < 12 || stem[stem.size() - 11] != '_' || !parse_date(stem.substr(stem.size() - 10), date))
+            return false;
+        run.ticker = stem.substr(0, stem.size() - 11);
+        run.expiration = stem.substr(stem.size() - 10);
+        return true;
+    }
+
+    // parse the dumps of one expiration into strike-sorted runs and k-way merge them by type and strike;
+    // ties keep the order of the files
+    struct DumpGroup
+    {
+        std::string ticker, expiration;
+        std::vector<std::filesystem::path> files;
+        std::vector<DumpRun> runs;
+        std::vector<const DumpQuote *> merged;
+    };
+
+    void merge_group(DumpGroup &group)
+    {
+        group.runs.resize(group.files.size());
+        for (size_t r = 0; r < group.files.size(); ++r)
+        {
+            DumpRun &run = group.runs[r];
+            int side;
+            parse_dump_name(group.files[r], run, side);
+            try
+            {
+                if (side == 0)
+                    read_json_dump(group.files[r].string(), run);
+                else
+                    read_csv_dump(group.files[r].string(), side == 2, run);
+            }
+            catch (const std::exception &e)
+            {
+                std::cout << "Error reading " << group.files[r].string() << ": " << e.what() << std::endl;
+                run.quotes.clear();
+                continue;
+            }
+            std::stable_sort(run.quotes.begin(), run.quotes.end(), [](const DumpQuote &a, const DumpQuote &b)
+                             { return a.put != b.put ? b.put : a.strike < b.strike; });
+        }
+
+        const auto &runs = group.runs;
+        // heap entries are (run, position), the smallest quote on top
+        auto greater = [&runs](const std::pair<size_t, size_t> &a, const std::pair<size_t, size_t> &b)
+        {
+            const DumpQuote &x = runs[a.first].quotes[a.second], &y = runs[b.first].quotes[b.second];
+            if (x.put != y.put)
+                return x.put;
+            if (x.strike != y.strike)
+                return x.strike > y.strike;
+            return a.first > b.first;
+        };
+        std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>, decltype(greater)> heap(greater);
+        size_t total = 0;
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            total += runs[r].quotes.size();
+            if (!runs[r].quotes.empty())
+                heap.push({r, 0});
+        }
+        group.merged.reserve(total);
+        while (!heap.empty())
+        {
+            auto [r, i] = heap.top();
+            heap.pop();
+            group.merged.push_back(&runs[r].quotes[i]);
+            if (i + 1 < runs[r].quotes.size())
+                heap.push({r, i + 1});
+        }
+    }
+
+    // hand the merged quotes of every expiration to sink(ticker, market, expiration, timeToMaturity, quotes)
+    // in ticker and expiration order; the expirations are parsed and merged in parallel a batch at a time
+    // and each batch's runs are released once the sink has taken them, so only one batch is ever resident;
+    // returns the number of contracts read
+    template <typename Sink>
+    size_t stream_dump_directory(const std::string &directory, Sink sink)
+    {
+        namespace fs = std::filesystem;
+        std::error_code error;
+        if (!fs::is_directory(directory, error))
+        {
+            std::cout << "Error: " << directory << " is not a directory" << std::endl;
+            return 0;
+        }
+        std::unordered_map<std::string, MarketData> market = read_market_file((fs::path(directory) / "market.csv").string());
+
+        // the dump files in name order, so the runs of one expiration merge in the same order every time
+        std::vector<fs::path> files;
+        for (const auto &entry : fs::directory_iterator(directory))
+        {
+            if (entry.is_regular_file() && entry.path().filename() != "market.csv")
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+
+        // group the files by ticker and expiration from their names alone; the map keeps the expirations
+        // of a ticker in date order
+        std::map<std::pair<std::string, std::string>, std::vector<fs::path>> groups;
+        for (const fs::path &file : files)
+        {
+            DumpRun run;
+            int side;
+            if (!parse_dump_name(file, run, side))
+                continue;
+            if (market.find(run.ticker) == market.end())
+            {
+                std::cout << "Error: no market data for " << run.ticker << ", skipping " << file.filename().string() << std::endl;
+                continue;
+            }
+            groups[{run.ticker, run.expiration}].push_back(file);
+        }
+
+        size_t contracts = 0;
+        std::vector<DumpGroup> batch;
+        const size_t batchSize = 4 * size_t{parallel_threads()};
+        for (auto next = groups.begin(); next != groups.end();)
+        {
+            batch.clear();
+            for (; next != groups.end() && batch.size() < batchSize; ++next)
+            {
+                batch.push_back({next->first.first, next->first.second, std::move(next->second), {}, {}});
+            }
+            parallel_for(batch.size(), [&batch](size_t begin, size_t end)
+                         {
+                for (size_t g = begin; g < end; ++g)
+                {
+                    merge_group(batch[g]);
+                } });
+
+            for (const DumpGroup &group : batch)
+            {
+                const MarketData &data = market.at(group.ticker);
+                std::chrono::sys_days expiration;
+                parse_date(group.expiration, expiration);
+                double timeToMaturity = std::round((expiration - data.asOf).count() / 365.0 * 1e6) / 1e6;
+                sink(group.ticker, data, group.expiration, timeToMaturity, group.merged);
+                contracts += group.merged.size();
+            }
+        }
+        return contracts;
+    }
+}
+
+size_t read_chain_dump_directory(const std::string &directory, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers)
+{
+    size_t contracts = stream_dump_directory(
+        directory, [&tickers](const std::string &name, const MarketData &data, const std::string &expiration,
+                              double timeToMaturity, const std::vector<const DumpQuote *> &quotes)
+        {
+            auto &ticker = tickers[name];
+            if (!ticker)
+            {
+                ticker = std::make_unique<Ticker>(name, data.spotPrice, data.interestRate);
+            }
+            for (const DumpQuote *quote : quotes)
+            {
+                ticker->addOptionData(std::make_unique<OptionData>(expiration, timeToMaturity, quote->strike,
+                                                                   quote->put ? "Put" : "Call", quote->lastPrice, quote->bid,
+                                                                   quote->ask, quote->volume, quote->openInterest,
+                                                                   quote->impliedVolatility, quote->inTheMoney));
+            }
+        });
+
+    for (auto &[name, tickerObj] : tickers)
+    {
+        tickerObj->build_slices();
+    }
+    return contracts;
+}
+
+size_t read_chain_dump_directory(const std::string &directory, std::unordered_map<std::string, CompactChain> &chains,
+                                 bool diagnostics)
+{
+    size_t contracts = stream_dump_directory(
+        directory, [&chains, diagnostics](const std::string &name, const MarketData &data, const std::string &expiration,
+                                          double timeToMaturity, const std::vector<const DumpQuote *> &quotes)
+        {
+            auto it = chains.try_emplace(name, name, data.spotPrice, data.interestRate, diagnostics).first;
+            for (const DumpQuote *quote : quotes)
+            {
+                it->second.add(expiration, timeToMaturity, quote->strike, quote->put, quote->lastPrice, quote->bid,
+                               quote->ask, quote->volume, quote->openInterest, quote->impliedVolatility, quote->inTheMoney);
+            }
+        });
+
+    for (auto &[name, chain] : chains)
+    {
+        chain.finish();
+    }
+    return contracts;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Ticker.h"
+#include "CompactChain.h"
+
+// read a directory of raw per-expiration chain dumps, the data download-data.ipynb builds options_data*.csv
+// from, straight into Tickers:
+//   market.csv                           ticker,spotPrice,interestRate,asOf (rate in percent like the ^IRX
+//                                        close, asOf the download date YYYY-MM-DD)
+//   <ticker>_<YYYY-MM-DD>.json           Yahoo options response of one expiration, its calls and puts arrays
+//   <ticker>_<YYYY-MM-DD>_calls.csv      yfinance option_chain(date).calls / .puts written with to_csv
+//   <ticker>_<YYYY-MM-DD>_puts.csv
+// the dumps are grouped by expiration from their file names; a batch of expirations at a time is parsed in
+// parallel, each dump into a strike-sorted run, the runs k-way merged by type and strike into the chain
+// order of build_slices and released once appended, so memory stays at one batch of raw quotes;
+// time to maturity is the notebook's (expiration - asOf) days / 365 rounded to 6 decimals, and the tickers
+// are added to the map like read_csv_into_ticker_object does; returns the number of contracts read
+size_t read_chain_dump_directory(const std::string &directory, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers);
+
+// read the same dumps straight into compact chains, appending each merged expiration without building a
+// Ticker; diagnostics adds the side table of the rarely read outputs to every chain
+size_t read_chain_dump_directory(const std::string &directory, std::unordered_map<std::string, CompactChain> &chains,
+                                 bool diagnostics = false);
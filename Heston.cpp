@@ -0,0 +1,640 @@
+#include "Heston.h"
+#include "util.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    using cd = std::complex<double>;
+
+    // characteristic function of ln(S_T / F) in the "little Heston trap" form, which keeps
+    // the complex logarithm on its principal branch for long maturities
+    cd heston_cf(cd u, double T, const HestonParams &p)
+    {
+        const cd i(0.0, 1.0);
+        double sigma2 = p.sigma * p.sigma;
+
+        cd xi = p.kappa - p.sigma * p.rho * i * u;
+        cd d = std::sqrt(xi * xi + sigma2 * (u * u + i * u));
+        cd g = (xi - d) / (xi + d);
+        cd e = std::exp(-d * T);
+
+        cd D = (xi - d) / sigma2 * (1.0 - e) / (1.0 - g * e);
+        cd C = p.kappa * p.theta / sigma2 * ((xi - d) * T - 2.0 * std::log((1.0 - g * e) / (1.0 - g)));
+        return std::exp(C + D * p.v0);
+    }
+
+    // 8 point Gauss-Legendre rule on [-1, 1]
+    constexpr std::array<double, 8> legendre_nodes = {-0.9602898564975363, -0.7966664774136267, -0.5255324099163290,
+                                                      -0.1834346424956498, 0.1834346424956498, 0.5255324099163290,
+                                                      0.7966664774136267, 0.9602898564975363};
+    constexpr std::array<double, 8> legendre_weights = {0.1012285362903763, 0.2223810344533745, 0.3137066458778873,
+                                                        0.3626837833783620, 0.3626837833783620, 0.3137066458778873,
+                                                        0.2223810344533745, 0.1012285362903763};
+
+    // on the integral, whose error reaches the price multiplied by D sqrt(F K) / pi, so about 2e-7 for SPY
+    constexpr double truncation_tolerance = 1e-9; // tail beyond uMax
+    constexpr double panel_tolerance = 1e-9;      // interpolation error on a panel times its width
+    constexpr double max_truncation = 1 << 20;
+    constexpr int max_depth = 20;
+
+    // phi(u - i/2) / (u^2 + 1/4), the integrand of the Lewis formula before the strike phase
+    cd lewis_integrand(double u, double T, const HestonParams &p)
+    {
+        return heston_cf(cd(u, -0.5), T, p) / (u * u + 0.25);
+    }
+
+    // where u |integrand(u)| drops below the tolerance as u doubles; |phi(u - i/2)| <= 1 and decays at least
+    // exponentially, so the tail beyond is below it too
+    double truncation_point(double T, const HestonParams &p)
+    {
+        double uMax = 1.0;
+        while (uMax < max_truncation && uMax * std::abs(lewis_integrand(uMax, T, p)) > truncation_tolerance)
+        {
+            uMax *= 2;
+        }
+        return uMax;
+    }
+
+    // power series coefficients of the Lagrange basis polynomials of the nodes, l_i(t) = sum_n c[i][n] t^n
+    const std::array<std::array<double, 8>, 8> &lagrange_coefficients()
+    {
+        static const std::array<std::array<double, 8>, 8> coefficients = []
+        {
+            std::array<std::array<double, 8>, 8> c{};
+            for (int i = 0; i < 8; ++i)
+            {
+                // multiply out prod_{j != i} (t - t_j) / (t_i - t_j)
+                c[i][0] = 1.0;
+                int degree = 0;
+                for (int j = 0; j < 8; ++j)
+                {
+                    if (j == i)
+                        continue;
+                    double scale = 1.0 / (legendre_nodes[i] - legendre_nodes[j]);
+                    for (int n = degree + 1; n > 0; --n)
+                        c[i][n] = (c[i][n - 1] - legendre_nodes[j] * c[i][n]) * scale;
+                    c[i][0] *= -legendre_nodes[j] * scale;
+                    degree++;
+                }
+            }
+            return c;
+        }();
+        return coefficients;
+    }
+
+    // M_n = int_{-1}^{1} t^n e^(i w t) dt for n < 8; the recursion M_n = ([t^n e^(i w t)]_{-1}^{1} - n M_{n-1}) / (i w)
+    // is stable for |w| >= 8 > n, below that the Taylor series of e^(i w t) converges quickly
+    std::array<cd, 8> oscillatory_moments(double w)
+    {
+        std::array<cd, 8> m;
+        if (std::abs(w) >= 8)
+        {
+            const cd iw(0.0, w);
+            cd up = std::polar(1.0, w), down = std::polar(1.0, -w);
+            m[0] = (up - down) / iw;
+            for (int n = 1; n < 8; ++n)
+            {
+                m[n] = (up - (n % 2 ? -down : down) - static_cast<double>(n) * m[n - 1]) / iw;
+            }
+            return m;
+        }
+        m.fill(0.0);
+        cd term = 1.0; // (i w)^j / j!
+        for (int j = 0; j < 60; ++j)
+        {
+            for (int n = j % 2; n < 8; n += 2)
+            {
+                m[n] += term * (2.0 / (n + j + 1));
+            }
+            term *= cd(0.0, w) / static_cast<double>(j + 1);
+        }
+        return m;
+    }
+
+    // weights of a panel's nodes for int f(u) e^(i u k) du over [mid - half, mid + half], with f replaced by
+    // its interpolant at the nodes; at k = 0 they are the Gauss-Legendre weights
+    std::array<cd, 8> filon_weights(double mid, double half, double k)
+    {
+        std::array<cd, 8> moments = oscillatory_moments(half * k);
+        const auto &lagrange = lagrange_coefficients();
+        cd scale = half * std::polar(1.0, mid * k);
+        std::array<cd, 8> weights;
+        for (int i = 0; i < 8; ++i)
+        {
+            cd sum = 0.0;
+            for (int n = 0; n < 8; ++n)
+            {
+                sum += lagrange[i][n] * moments[n];
+            }
+            weights[i] = scale * sum;
+        }
+        return weights;
+    }
+
+    // the parameter sets at the corners of a box, each parameter at its lower or upper bound
+    std::vector<HestonParams> box_corners(const HestonParams &lower, const HestonParams &upper)
+    {
+        std::array<double, 5> lo = {lower.kappa, lower.theta, lower.sigma, lower.rho, lower.v0};
+        std::array<double, 5> hi = {upper.kappa, upper.theta, upper.sigma, upper.rho, upper.v0};
+        std::vector<HestonParams> corners;
+        for (int mask = 0; mask < 32; ++mask)
+        {
+            std::array<double, 5> p;
+            bool duplicate = false;
+            for (int d = 0; d < 5; ++d)
+            {
+                bool high = mask >> d & 1;
+                duplicate |= high && hi[d] == lo[d];
+                p[d] = high ? hi[d] : lo[d];
+            }
+            if (!duplicate)
+                corners.push_back({p[0], p[1], p[2], p[3], p[4]});
+        }
+        return corners;
+    }
+
+    // cut [a, b] into panels on which the interpolant at the nodes holds for every corner: the whole panel's
+    // interpolant is checked against the integrand at the nodes of its two halves
+    void split_panel(double a, double b, double T, const std::vector<HestonParams> &corners, int depth,
+                     std::vector<std::pair<double, double>> &panels)
+    {
+        double mid = 0.5 * (a + b), half = 0.5 * (b - a);
+        const auto &lagrange = lagrange_coefficients();
+        bool holds = true;
+        for (size_t c = 0; c < corners.size() && holds && depth < max_depth; ++c)
+        {
+            std::array<cd, 8> poly{};
+            for (int i = 0; i < 8; ++i)
+            {
+                cd value = lewis_integrand(mid + half * legendre_nodes[i], T, corners[c]);
+                for (int n = 0; n < 8; ++n)
+                    poly[n] += value * lagrange[i][n];
+            }
+            double error = 0.0;
+            for (double side : {-1.0, 1.0})
+            {
+                for (int i = 0; i < 8; ++i)
+                {
+                    double t = 0.5 * (side + legendre_nodes[i]);
+                    cd interpolant = 0.0;
+                    for (int n = 7; n >= 0; --n)
+                        interpolant = interpolant * t + poly[n];
+                    error = std::max(error, std::abs(interpolant - lewis_integrand(mid + half * t, T, corners[c])));
+                }
+            }
+            holds = error * (b - a) <= panel_tolerance; // false for a non-finite integrand as well
+        }
+        if (holds || depth >= max_depth)
+        {
+            panels.emplace_back(mid, half);
+            return;
+        }
+        split_panel(a, mid, T, corners, depth + 1, panels);
+        split_panel(mid, b, T, corners, depth + 1, panels);
+    }
+
+    // box bounds of kappa, theta, sigma, rho and v0 during calibration, which also size the pricing grids
+    constexpr std::array<double, 5> lower_bounds = {0.1, 1e-3, 0.05, -0.95, 1e-3};
+    constexpr std::array<double, 5> upper_bounds = {20.0, 4.0, 5.0, 0.95, 4.0};
+    constexpr const char *parameter_names[] = {"kappa", "theta", "sigma", "rho", "v0"};
+    // a fitted parameter this close to a bound, as a fraction of its range, ended the search on the bound
+    constexpr double bound_tolerance = 1e-3;
+
+    HestonParams as_params(const std::array<double, 5> &p)
+    {
+        return {p[0], p[1], p[2], p[3], p[4]};
+    }
+
+    // unconstrained search coordinates to bounded Heston parameters through a logistic map
+    HestonParams to_params(const std::array<double, 5> &x)
+    {
+        std::array<double, 5> p;
+        for (int d = 0; d < 5; ++d)
+        {
+            p[d] = lower_bounds[d] + (upper_bounds[d] - lower_bounds[d]) / (1.0 + std::exp(-x[d]));
+        }
+        return as_params(p);
+    }
+
+    // inverse of to_params
+    std::array<double, 5> to_coordinates(const HestonParams &params)
+    {
+        std::array<double, 5> p = {params.kappa, params.theta, params.sigma, params.rho, params.v0};
+        std::array<double, 5> x;
+        for (int d = 0; d < 5; ++d)
+        {
+            double u = (std::clamp(p[d], lower_bounds[d], upper_bounds[d]) - lower_bounds[d]) / (upper_bounds[d] - lower_bounds[d]);
+            u = std::clamp(u, 1e-6, 1 - 1e-6);
+            x[d] = std::log(u / (1 - u));
+        }
+        return x;
+    }
+
+    // solve the symmetric positive definite 5 x 5 system m x = b in place by Cholesky, false if m is not
+    // positive definite
+    bool solve_symmetric5(std::array<std::array<double, 5>, 5> &m, std::array<double, 5> &b)
+    {
+        for (int j = 0; j < 5; ++j)
+        {
+            double diagonal = m[j][j];
+            for (int k = 0; k < j; ++k)
+                diagonal -= m[j][k] * m[j][k];
+            if (!(diagonal > 0))
+                return false;
+            m[j][j] = std::sqrt(diagonal);
+            for (int i = j + 1; i < 5; ++i)
+            {
+                double sum = m[i][j];
+                for (int k = 0; k < j; ++k)
+                    sum -= m[i][k] * m[j][k];
+                m[i][j] = sum / m[j][j];
+            }
+        }
+        for (int i = 0; i < 5; ++i) // L y = b
+        {
+            for (int k = 0; k < i; ++k)
+                b[i] -= m[i][k] * b[k];
+            b[i] /= m[i][i];
+        }
+        for (int i = 4; i >= 0; --i) // L' x = y
+        {
+            for (int k = i + 1; k < 5; ++k)
+                b[i] -= m[k][i] * b[k];
+            b[i] /= m[i][i];
+        }
+        return true;
+    }
+
+    // the quotes of one expiration that enter the calibration
+    struct ExpiryQuotes
+    {
+        HestonPricer pricer;
+        std::vector<double> strikes;
+        std::vector<PayoffType> payoffTypes;
+        std::vector<double> marketPrices;
+        std::vector<double> vegas;
+        std::vector<double> modelPrices;
+        double discount;
+    };
+}
+
+HestonPricer::HestonPricer(double time_to_maturity, double forward, double discount_factor)
+    : time_to_maturity_(time_to_maturity), forward_(forward), discount_factor_(discount_factor) {}
+
+void HestonPricer::build_grid(const HestonParams &lower, const HestonParams &upper)
+{
+    double T = time_to_maturity_;
+    std::vector<HestonParams> corners = box_corners(lower, upper);
+    truncation_ = 1.0;
+    for (const HestonParams &corner : corners)
+    {
+        truncation_ = std::max(truncation_, truncation_point(T, corner));
+    }
+
+    // panels [0, 1], [1, 2], [2, 4], ... as the integrand spreads out with u, then split where a corner needs it
+    std::vector<std::pair<double, double>> panels;
+    for (double a = 0, b = 1; a < truncation_; a = b, b *= 2)
+    {
+        split_panel(a, b, T, corners, 0, panels);
+    }
+
+    panel_mid_.clear();
+    panel_half_.clear();
+    nodes_.clear();
+    for (const auto &[mid, half] : panels)
+    {
+        panel_mid_.push_back(mid);
+        panel_half_.push_back(half);
+        for (double node : legendre_nodes)
+        {
+            nodes_.push_back(mid + half * node);
+        }
+    }
+    coeff_re_.assign(nodes_.size(), 0.0);
+    coeff_im_.assign(nodes_.size(), 0.0);
+    strike_weights_();
+}
+
+void HestonPricer::set_params(const HestonParams &params)
+{
+    if (nodes_.empty())
+    {
+        build_grid(params, params);
+    }
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        cd coeff = lewis_integrand(nodes_[i], time_to_maturity_, params);
+        coeff_re_[i] = coeff.real();
+        coeff_im_[i] = coeff.imag();
+    }
+}
+
+double HestonPricer::call_from_integral_(double strike, double integral) const
+{
+    return discount_factor_ * (forward_ - std::sqrt(forward_ * strike) / std::numbers::pi * integral);
+}
+
+void HestonPricer::strike_weights_()
+{
+    size_t n = nodes_.size();
+    weight_re_.resize(strikes_.size() * n);
+    weight_im_.resize(strikes_.size() * n);
+    for (size_t j = 0; j < strikes_.size(); ++j)
+    {
+        double k = std::log(forward_ / strikes_[j]);
+        for (size_t p = 0; p < panel_mid_.size(); ++p)
+        {
+            std::array<cd, 8> weights = filon_weights(panel_mid_[p], panel_half_[p], k);
+            for (int i = 0; i < 8; ++i)
+            {
+                weight_re_[j * n + 8 * p + i] = weights[i].real();
+                weight_im_[j * n + 8 * p + i] = weights[i].imag();
+            }
+        }
+    }
+}
+
+double HestonPricer::operator()(double strike, PayoffType payoff_type) const
+{
+    double k = std::log(forward_ / strike);
+    double integral = 0.0;
+    for (size_t p = 0; p < panel_mid_.size(); ++p)
+    {
+        std::array<cd, 8> weights = filon_weights(panel_mid_[p], panel_half_[p], k);
+        for (int i = 0; i < 8; ++i)
+        {
+            integral += coeff_re_[8 * p + i] * weights[i].real() - coeff_im_[8 * p + i] * weights[i].imag();
+        }
+    }
+    double call = call_from_integral_(strike, integral);
+    // put from put-call parity on the forward
+    return payoff_type == PayoffType::Call ? call : call - discount_factor_ * (forward_ - strike);
+}
+
+void HestonPricer::set_strikes(const std::vector<double> &strikes)
+{
+    strikes_ = strikes;
+    strike_weights_();
+}
+
+void HestonPricer::price_strikes(const std::vector<PayoffType> &payoff_types, std::vector<double> &prices) const
+{
+    size_t n = nodes_.size();
+    prices.resize(strikes_.size());
+    for (size_t j = 0; j < strikes_.size(); ++j)
+    {
+        // Re[weight * coeff] summed over the nodes
+        const double *weightRe = weight_re_.data() + j * n, *weightIm = weight_im_.data() + j * n;
+        double integral = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            integral += coeff_re_[i] * weightRe[i] - coeff_im_[i] * weightIm[i];
+        }
+        double call = call_from_integral_(strikes_[j], integral);
+        prices[j] = payoff_types[j] == PayoffType::Call ? call : call - discount_factor_ * (forward_ - strikes_[j]);
+    }
+}
+
+HestonCalibration calibrate_heston(const Ticker &ticker, int max_evaluations)
+{
+    auto start = std::chrono::steady_clock::now();
+    double spot = ticker.getSpotPrice();
+
+    // out-of-the-money two sided quotes with a usable implied vol, grouped by expiration slice
+    struct Quote
+    {
+        double strike;
+        PayoffType payoffType;
+        double marketPrice;
+        double vega;
+        double impliedVol;
+    };
+    struct Expiry
+    {
+        double timeToMaturity, forward, discount;
+        std::vector<Quote> quotes;
+    };
+    std::vector<Expiry> expiries;
+
+    const auto &options = ticker.getOptions();
+    for (const ExpirySlice &slice : ticker.getSlices())
+    {
+        double T = slice.timeToMaturity;
+        if (T < 0.01)
+        {
+            continue;
+        }
+
+        const ParityFit *fit = ticker.findParityFit(slice.expiration);
+        double rate = fit ? fit->impliedRate : ticker.getInterestRate();
+        double dividend = fit ? fit->impliedDividend : 0.0;
+        double forward = spot * std::exp((rate - dividend) * T);
+        Expiry expiry{T, forward, std::exp(-rate * T), {}};
+
+        for (size_t i = slice.callBegin; i < slice.end; ++i)
+        {
+            const OptionData &option = *options[i];
+            double iv = option.implied_vol();
+            if (option.bid <= 0 || option.ask <= 0 || iv < 0.03 || iv > 2.0)
+            {
+                continue;
+            }
+
+            double k = std::log(option.strike / forward);
+            bool isCall = i < slice.putBegin;
+            if (isCall != (k >= 0) || std::abs(k) > 0.5)
+            {
+                continue; // in-the-money or far wing
+            }
+
+            PayoffType payoffType = isCall ? PayoffType::Call : PayoffType::Put;
+            BlackScholes bs(option.strike, spot, T, rate, payoffType, dividend);
+            double vega = bs.get_vega(iv);
+            double marketPrice = option.market_price();
+            if (vega < 0.01 || marketPrice < 0.05)
+            {
+                continue;
+            }
+            expiry.quotes.push_back({option.strike, payoffType, marketPrice, vega, iv});
+        }
+        expiries.push_back(std::move(expiry));
+    }
+
+    // one pricer per expiration with the strike phases precomputed for the whole search
+    std::vector<ExpiryQuotes> grids;
+    size_t numQuotes = 0;
+    double atmVariance = 0.0;
+    for (auto &expiry : expiries)
+    {
+        if (expiry.quotes.size() < 3)
+        {
+            continue;
+        }
+
+        std::vector<double> variances;
+        for (const auto &quote : expiry.quotes)
+        {
+            variances.push_back(quote.impliedVol * quote.impliedVol);
+        }
+        std::nth_element(variances.begin(), variances.begin() + variances.size() / 2, variances.end());
+        double referenceVariance = variances[variances.size() / 2];
+        if (grids.empty())
+        {
+            atmVariance = referenceVariance; // nearest expiration seeds v0 and theta
+        }
+
+        ExpiryQuotes grid{HestonPricer(expiry.timeToMaturity, expiry.forward, expiry.discount),
+                          {}, {}, {}, {}, {}, expiry.discount};
+        for (const auto &quote : expiry.quotes)
+        {
+            grid.strikes.push_back(quote.strike);
+            grid.payoffTypes.push_back(quote.payoffType);
+            grid.marketPrices.push_back(quote.marketPrice);
+            grid.vegas.push_back(quote.vega);
+        }
+        grid.pricer.set_strikes(grid.strikes);
+        numQuotes += expiry.quotes.size();
+        grids.push_back(std::move(grid));
+    }
+
+    HestonCalibration result{{2.0, atmVariance, 0.5, -0.6, atmVariance}, 0.0, numQuotes, 0, 0.0, {}};
+    if (grids.empty())
+    {
+        result.failure = "no usable quotes";
+        return result;
+    }
+
+    // one grid per expiration for the whole search, sized for every parameter set inside the bounds
+    parallel_for(grids.size(), [&grids](size_t begin, size_t end)
+                 {
+        for (size_t g = begin; g < end; ++g)
+        {
+            grids[g].pricer.build_grid(as_params(lower_bounds), as_params(upper_bounds));
+        } });
+
+    // vega weighted pricing errors of every quote, (model - market) / vega approximates the IV error;
+    // returns their mean square
+    int evaluations = 0;
+    auto residuals = [&](const std::array<double, 5> &x, std::vector<double> &errors)
+    {
+        evaluations++;
+        HestonParams params = to_params(x);
+        // the expirations are priced independently, the sum stays in order so the fit is deterministic
+        parallel_for(grids.size(), [&](size_t begin, size_t end)
+                     {
+            for (size_t g = begin; g < end; ++g)
+            {
+                grids[g].pricer.set_params(params);
+                grids[g].pricer.price_strikes(grids[g].payoffTypes, grids[g].modelPrices);
+            } });
+        errors.clear();
+        double sum = 0.0;
+        for (auto &grid : grids)
+        {
+            const HestonPricer &pricer = grid.pricer;
+            for (size_t j = 0; j < grid.modelPrices.size(); ++j)
+            {
+                // clamp into the no-arbitrage bounds D max(F - K, 0) <= C <= D F (puts D max(K - F, 0) <= P <= D K)
+                // so a quadrature error on extreme parameters cannot look like a better fit
+                double phi = static_cast<double>(grid.payoffTypes[j]);
+                double F = pricer.get_forward(), K = grid.strikes[j], D = grid.discount;
+                double model = std::clamp(grid.modelPrices[j], D * std::max(0.0, phi * (F - K)), D * (phi > 0 ? F : K));
+                double error = (model - grid.marketPrices[j]) / grid.vegas[j];
+                errors.push_back(std::isfinite(error) ? error : 1e5);
+                sum += errors.back() * errors.back();
+            }
+        }
+        return sum / numQuotes;
+    };
+
+    // Levenberg-Marquardt in the unconstrained coordinates with a forward difference Jacobian: each step
+    // solves (J'J + lambda diag(J'J)) dx = -J'e, lambda shrinks after a step that lowers the error and grows
+    // until one does; stops once a step gains less than a relative 1e-9
+    constexpr double difference_step = 1e-5;
+    std::array<double, 5> x = to_coordinates(result.params);
+    std::vector<double> errors, trialErrors, shiftedErrors;
+    double cost = residuals(x, errors);
+    std::vector<std::array<double, 5>> jacobian(numQuotes);
+    double lambda = 1e-3;
+    while (evaluations + 6 <= max_evaluations)
+    {
+        for (int d = 0; d < 5; ++d)
+        {
+            std::array<double, 5> shifted = x;
+            shifted[d] += difference_step;
+            residuals(shifted, shiftedErrors);
+            for (size_t q = 0; q < numQuotes; ++q)
+                jacobian[q][d] = (shiftedErrors[q] - errors[q]) / difference_step;
+        }
+        std::array<std::array<double, 5>, 5> normal{};
+        std::array<double, 5> gradient{};
+        for (size_t q = 0; q < numQuotes; ++q)
+        {
+            for (int a = 0; a < 5; ++a)
+            {
+                gradient[a] += jacobian[q][a] * errors[q];
+                for (int b = 0; b < 5; ++b)
+                    normal[a][b] += jacobian[q][a] * jacobian[q][b];
+            }
+        }
+
+        bool improved = false;
+        double gain = 0.0;
+        while (!improved && evaluations < max_evaluations && lambda < 1e10)
+        {
+            std::array<std::array<double, 5>, 5> damped = normal;
+            std::array<double, 5> step;
+            for (int a = 0; a < 5; ++a)
+            {
+                damped[a][a] += lambda * normal[a][a] + 1e-12;
+                step[a] = -gradient[a];
+            }
+            if (!solve_symmetric5(damped, step))
+            {
+                lambda *= 4;
+                continue;
+            }
+            std::array<double, 5> trial;
+            for (int d = 0; d < 5; ++d)
+                trial[d] = x[d] + step[d];
+            double trialCost = residuals(trial, trialErrors);
+            if (trialCost < cost)
+            {
+                gain = cost - trialCost;
+                x = trial;
+                errors.swap(trialErrors);
+                cost = trialCost;
+                lambda = std::max(lambda / 3, 1e-12);
+                improved = true;
+            }
+            else
+            {
+                lambda *= 4;
+            }
+        }
+        if (!improved || gain <= 1e-9 * cost)
+            break;
+    }
+
+    result.params = to_params(x);
+    result.rmse = std::sqrt(cost);
+    result.evaluations = evaluations;
+
+    // a search that ran into the box is a failure of the model on this chain, not a fit
+    std::array<double, 5> fitted = {result.params.kappa, result.params.theta, result.params.sigma, result.params.rho, result.params.v0};
+    for (int d = 0; d < 5 && result.failure.empty(); ++d)
+    {
+        double position = (fitted[d] - lower_bounds[d]) / (upper_bounds[d] - lower_bounds[d]);
+        if (position < bound_tolerance || position > 1 - bound_tolerance)
+        {
+            result.failure = std::string(parameter_names[d]) + (position < 0.5 ? " at its lower bound" : " at its upper bound");
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
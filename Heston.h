@@ -0,0 +1,79 @@
+#pragma once
+#include <complex>
+#include <string>
+#include <vector>
+#include "BlackScholes.h"
+#include "Ticker.h"
+
+// Heston model parameters: mean reversion speed, long run variance, vol of variance,
+// spot/variance correlation and initial variance
+struct HestonParams
+{
+    double kappa;
+    double theta;
+    double sigma;
+    double rho;
+    double v0;
+};
+
+// Heston pricer for one expiration, prices every strike off the same quadrature grid (Lewis formula)
+//   C = D * (F - sqrt(F K) / pi * int_0^inf Re[e^(i u ln(F / K)) phi(u - i / 2)] / (u^2 + 1/4) du)
+// the grid is sized once for a box of parameter sets and reused for every set inside it: [0, uMax] is cut
+// into panels on which phi(u - i/2) / (u^2 + 1/4) is interpolated at 8 Gauss-Legendre nodes, halved until
+// the interpolant holds at every corner of the box, and uMax is where the slowest decaying corner has
+// decayed; the strike phase e^(i u k) is integrated against the interpolant exactly (Filon), so the panels
+// only follow the characteristic function and the grid does not depend on the strikes
+class HestonPricer
+{
+public:
+    HestonPricer(double time_to_maturity, double forward, double discount_factor);
+
+    // size the grid for every parameter set in [lower, upper]
+    void build_grid(const HestonParams &lower, const HestonParams &upper);
+    // evaluate the characteristic function on the grid for a new parameter set; a pricer without a grid
+    // sizes one for this parameter set alone
+    void set_params(const HestonParams &params);
+
+    double operator()(double strike, PayoffType payoff_type) const;
+
+    // the strikes price_strikes prices, whose quadrature weights are computed once per grid
+    void set_strikes(const std::vector<double> &strikes);
+    void price_strikes(const std::vector<PayoffType> &payoff_types, std::vector<double> &prices) const;
+
+    double get_time_to_maturity() const { return time_to_maturity_; }
+    double get_forward() const { return forward_; }
+    // nodes of the grid and where it is truncated
+    size_t grid_size() const { return nodes_.size(); }
+    double truncation() const { return truncation_; }
+
+private:
+    double call_from_integral_(double strike, double integral) const;
+    void strike_weights_();
+
+    double time_to_maturity_, forward_, discount_factor_;
+    double truncation_ = 0.0;
+    std::vector<double> panel_mid_, panel_half_; // panel centres and half widths, 8 nodes each
+    std::vector<double> nodes_;                  // u values of the grid
+    // phi(u - i/2) / (u^2 + 1/4) at every node, split into real and imaginary parts
+    std::vector<double> coeff_re_, coeff_im_;
+    std::vector<double> strikes_;
+    // Filon weight of node i for strike j at [j * grid_size() + i], the strike's integral is
+    // Re[sum_i weight * coeff]
+    std::vector<double> weight_re_, weight_im_;
+};
+
+// result of fitting the Heston parameters to a chain
+struct HestonCalibration
+{
+    HestonParams params;
+    double rmse;         // vega weighted RMS pricing error, roughly in implied vol units
+    size_t quotes;       // number of quotes in the fit
+    int evaluations;     // pricings of the whole chain by the Levenberg-Marquardt search
+    double seconds;
+    std::string failure; // empty for a fit, otherwise why there is none, e.g. a parameter that ended on its bound
+};
+
+// fit the Heston parameters to the out-of-the-money two sided quotes of a Ticker with at most
+// max_evaluations pricings of the chain; put-call parity and the implied vols should be calculated
+// first so forwards and vegas are available
+HestonCalibration calibrate_heston(const Ticker &ticker, int max_evaluations = 300);
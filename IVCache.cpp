@@ -0,0 +1,211 @@
+#include "IVCache.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr char cache_magic[8] = {'F', 'E', '6', '2', '1', 'I', 'V', 'C'};
+    constexpr uint32_t cache_version = 1;
+
+    // keys are hashes, 0 is reserved for empty slots
+    uint64_t normalize_key(uint64_t key)
+    {
+        return key == 0 ? 1 : key;
+    }
+}
+
+IVCache::IVCache(const std::string &path, size_t capacity) : path_(path)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+    {
+        std::cerr << "Error: Unable to open IV cache " << path << std::endl;
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+    {
+        std::cerr << "Error: Unable to stat IV cache " << path << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    // reuse the existing file if its layout matches this build
+    char magic[sizeof(cache_magic)] = {};
+    bool ours = static_cast<size_t>(st.st_size) >= sizeof(magic) &&
+                ::pread(fd_, magic, sizeof(magic), 0) == sizeof(magic) &&
+                std::memcmp(magic, cache_magic, sizeof(cache_magic)) == 0;
+    if (ours && static_cast<size_t>(st.st_size) >= sizeof(Header))
+    {
+        Header header;
+        if (::pread(fd_, &header, sizeof(header), 0) == sizeof(header) &&
+            header.version == cache_version && header.entrySize == sizeof(Entry) &&
+            std::has_single_bit(header.capacity) &&
+            static_cast<size_t>(st.st_size) == sizeof(Header) + header.capacity * sizeof(Entry) &&
+            map_(header.capacity, false))
+        {
+            return;
+        }
+    }
+
+    // never overwrite a file that is not an IV cache, run without one instead
+    if (!ours && st.st_size != 0)
+    {
+        std::cerr << "Error: " << path << " is not an IV cache, running without one" << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    // an empty file or a cache from another build starts over empty
+    if (::ftruncate(fd_, 0) != 0 || !map_(std::bit_ceil(std::max<size_t>(capacity, 16)), true))
+    {
+        std::cerr << "Error: Unable to create IV cache " << path << std::endl;
+    }
+}
+
+IVCache::~IVCache()
+{
+    unmap_();
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+bool IVCache::map_(size_t capacity, bool create)
+{
+    size_t size = sizeof(Header) + capacity * sizeof(Entry);
+    if (create && ::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    {
+        return false;
+    }
+
+    void *addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+
+    map_addr_ = addr;
+    map_size_ = size;
+    header_ = static_cast<Header *>(addr);
+    entries_ = reinterpret_cast<Entry *>(header_ + 1);
+
+    if (create)
+    {
+        std::memset(addr, 0, size);
+        std::memcpy(header_->magic, cache_magic, sizeof(cache_magic));
+        header_->version = cache_version;
+        header_->entrySize = sizeof(Entry);
+        header_->capacity = capacity;
+        header_->count = 0;
+    }
+    return true;
+}
+
+void IVCache::unmap_()
+{
+    if (map_addr_)
+    {
+        ::msync(map_addr_, map_size_, MS_ASYNC);
+        ::munmap(map_addr_, map_size_);
+    }
+    map_addr_ = nullptr;
+    map_size_ = 0;
+    header_ = nullptr;
+    entries_ = nullptr;
+}
+
+size_t IVCache::size() const
+{
+    return header_ ? header_->count : 0;
+}
+
+// linear probing: the slot holding key, or the empty slot where it would go
+IVCache::Entry *IVCache::slot_(uint64_t key) const
+{
+    uint64_t mask = header_->capacity - 1;
+    for (uint64_t i = key & mask;; i = (i + 1) & mask)
+    {
+        if (entries_[i].key == key || entries_[i].key == 0)
+        {
+            return &entries_[i];
+        }
+    }
+}
+
+const IVCache::Entry *IVCache::find(uint64_t key) const
+{
+    if (!header_)
+    {
+        return nullptr;
+    }
+    key = normalize_key(key);
+    Entry *slot = slot_(key);
+    return slot->key == key ? slot : nullptr;
+}
+
+void IVCache::store(const Entry &entry)
+{
+    if (!header_)
+    {
+        return;
+    }
+
+    // keep the load factor below 0.7 so probes stay short
+    if ((header_->count + 1) * 10 > header_->capacity * 7)
+    {
+        grow_();
+        if (!header_)
+        {
+            return;
+        }
+    }
+
+    Entry copy = entry;
+    copy.key = normalize_key(entry.key);
+    Entry *slot = slot_(copy.key);
+    if (slot->key == 0)
+    {
+        header_->count++;
+    }
+    *slot = copy;
+}
+
+// double the capacity and rehash every entry into the resized file
+void IVCache::grow_()
+{
+    std::vector<Entry> live;
+    live.reserve(header_->count);
+    for (uint64_t i = 0; i < header_->capacity; ++i)
+    {
+        if (entries_[i].key != 0)
+        {
+            live.push_back(entries_[i]);
+        }
+    }
+
+    size_t capacity = header_->capacity * 2;
+    unmap_();
+    if (!map_(capacity, true))
+    {
+        std::cerr << "Error: Unable to grow IV cache " << path_ << std::endl;
+        return;
+    }
+
+    for (const auto &entry : live)
+    {
+        *slot_(entry.key) = entry;
+    }
+    header_->count = live.size();
+}
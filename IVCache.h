@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// persistent, memory-mapped cache of solved IVs and greeks keyed by contract_hash
+// each entry also keeps a hash of the quote it was solved from, so a restart can reuse
+// unchanged contracts as they are and warm-start the solvers for the ones that moved
+class IVCache
+{
+public:
+    struct Entry
+    {
+        uint64_t key;       // contract_hash of the contract, 0 marks an empty slot
+        uint64_t quoteHash; // OptionData::quote_hash of the inputs the IVs were solved from
+        double bisectionImpliedVol;
+        double newtonImpliedVol;
+        double secantImpliedVol;
+        double delta_bs, gamma_bs, vega_bs;
+        double delta_fd, gamma_fd, vega_fd;
+    };
+
+    // how the contracts of a run were resolved
+    struct Stats
+    {
+        size_t hits = 0;       // unchanged quote, loaded from the cache
+        size_t warmStarts = 0; // changed quote, solved from the cached IV
+        size_t misses = 0;     // not cached, solved from the default guesses
+    };
+
+    // open or create the cache file, capacity is rounded up to a power of two
+    explicit IVCache(const std::string &path, size_t capacity = 1 << 16);
+    ~IVCache();
+
+    IVCache(const IVCache &) = delete;
+    IVCache &operator=(const IVCache &) = delete;
+
+    bool is_open() const { return header_ != nullptr; }
+    size_t size() const;
+
+    // nullptr if the contract has never been stored
+    const Entry *find(uint64_t key) const;
+    // insert or overwrite the entry of entry.key
+    void store(const Entry &entry);
+
+    Stats stats;
+
+private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t entrySize;
+        uint64_t capacity;
+        uint64_t count;
+    };
+
+    bool map_(size_t capacity, bool create);
+    void unmap_();
+    void grow_();
+    Entry *slot_(uint64_t key) const;
+
+    std::string path_;
+    int fd_ = -1;
+    void *map_addr_ = nullptr;
+    size_t map_size_ = 0;
+    Header *header_ = nullptr;
+    Entry *entries_ = nullptr;
+};
@@ -0,0 +1,121 @@
+#include "Loader.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    // one row of the options_data layout
+    struct QuoteRow
+    {
+        std::string ticker, expiration, optionType;
+        double timeToMaturity, strike, lastPrice, bid, ask, volume, openInterest, impliedVolatility, spotPrice, interestRate;
+        bool inTheMoney;
+    };
+
+    void parse_quote_row(const std::string &line_, QuoteRow &row)
+    {
+        std::stringstream ss(line_);
+        std::string temp;
+
+        std::getline(ss, temp, ','); // Ignore first empty column
+        std::getline(ss, row.ticker, ',');
+        std::getline(ss, row.expiration, ',');
+        std::getline(ss, temp, ',');
+        row.timeToMaturity = std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.strike = std::stod(temp);
+        std::getline(ss, row.optionType, ',');
+        std::getline(ss, temp, ',');
+        row.lastPrice = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.bid = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.ask = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.volume = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.openInterest = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.impliedVolatility = temp.empty() ? 0.0 : std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.inTheMoney = (temp == "True");
+        std::getline(ss, temp, ',');
+        row.spotPrice = std::stod(temp);
+        std::getline(ss, temp, ',');
+        row.interestRate = std::stod(temp);
+        row.interestRate = row.interestRate / 100;
+    }
+}
+
+void read_csv_into_ticker_object(const std::string &fileName, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers)
+{
+    std::ifstream ifile(fileName, std::ios::in);
+    if (!ifile.is_open())
+    {
+        std::cout << "Error opening file for input!" << std::endl;
+        return;
+    }
+
+    std::string line_;
+    QuoteRow row;
+
+    // getting rid of headers
+    std::getline(ifile, line_);
+
+    while (std::getline(ifile, line_))
+    {
+        parse_quote_row(line_, row);
+
+        if (tickers.find(row.ticker) == tickers.end())
+        {
+            tickers[row.ticker] = std::make_unique<Ticker>(row.ticker, row.spotPrice, row.interestRate);
+        }
+
+        // Create a new OptionData object
+        auto option = std::make_unique<OptionData>(row.expiration, row.timeToMaturity, row.strike, row.optionType,
+                                                   row.lastPrice, row.bid, row.ask, row.volume, row.openInterest,
+                                                   row.impliedVolatility, row.inTheMoney);
+
+        // Add option data to the existing Ticker object
+        tickers[row.ticker]->addOptionData(std::move(option));
+    }
+
+    ifile.close();
+
+    // lay every chain out as strike-sorted slices per expiration
+    for (auto &[name, tickerObj] : tickers)
+    {
+        tickerObj->build_slices();
+    }
+}
+
+void read_csv_into_compact_chains(const std::string &fileName, std::unordered_map<std::string, CompactChain> &chains,
+                                  bool diagnostics)
+{
+    std::ifstream ifile(fileName, std::ios::in);
+    if (!ifile.is_open())
+    {
+        std::cout << "Error opening file for input!" << std::endl;
+        return;
+    }
+
+    std::string line_;
+    QuoteRow row;
+
+    // getting rid of headers
+    std::getline(ifile, line_);
+
+    while (std::getline(ifile, line_))
+    {
+        parse_quote_row(line_, row);
+        auto it = chains.try_emplace(row.ticker, row.ticker, row.spotPrice, row.interestRate, diagnostics).first;
+        it->second.add(row.expiration, row.timeToMaturity, row.strike, row.optionType != "Call", row.lastPrice,
+                       row.bid, row.ask, row.volume, row.openInterest, row.impliedVolatility, row.inTheMoney);
+    }
+
+    for (auto &[name, chain] : chains)
+    {
+        chain.finish();
+    }
+}
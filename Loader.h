@@ -0,0 +1,17 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Ticker.h"
+#include "CompactChain.h"
+
+// read an option chain csv in the options_data layout (index,ticker,expiration,timeToMaturity,strike,
+// optionType,lastPrice,bid,ask,volume,openInterest,impliedVolatility,inTheMoney,spotPrice,interestRate)
+// into one Ticker per symbol, creating the tickers that are not in the map yet; every chain is
+// sliced by expiration once loaded
+void read_csv_into_ticker_object(const std::string &fileName, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers);
+
+// read the same layout straight into compact chains, without building an OptionData per contract;
+// diagnostics adds the side table of the rarely read outputs to every chain
+void read_csv_into_compact_chains(const std::string &fileName, std::unordered_map<std::string, CompactChain> &chains,
+                                  bool diagnostics = false);
@@ -0,0 +1,357 @@
+#include "LocalVol.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // bounds on the implied vols that enter the surface and on the extracted local vol
+    constexpr double min_iv = 0.01;
+    constexpr double max_iv = 2.5;
+    constexpr double min_local_variance = 0.05 * 0.05;
+    constexpr double max_local_variance = 2.0 * 2.0;
+    // expirations with fewer usable quotes than this are left out of the surface
+    constexpr size_t min_quotes = 5;
+    // passes of the [1 2 1] / 4 smoothing kernel applied to each total variance row
+    constexpr int smoothing_passes = 3;
+
+    // out-of-the-money smile of one expiration as (log-moneyness, total variance) points
+    struct Smile
+    {
+        double timeToMaturity;
+        double forward;
+        std::vector<std::pair<double, double>> points;
+    };
+
+    // linear interpolation of sorted (x, y) points, flat outside the data
+    double interpolate_points(const std::vector<std::pair<double, double>> &points, double x)
+    {
+        if (x <= points.front().first)
+            return points.front().second;
+        if (x >= points.back().first)
+            return points.back().second;
+
+        auto hi = std::lower_bound(points.begin(), points.end(), x,
+                                   [](const std::pair<double, double> &p, double value)
+                                   { return p.first < value; });
+        auto lo = hi - 1;
+        double weight = (x - lo->first) / (hi->first - lo->first);
+        return lo->second + weight * (hi->second - lo->second);
+    }
+}
+
+LocalVolSurface LocalVolSurface::from_ticker(const Ticker &ticker, size_t num_strikes)
+{
+    LocalVolSurface surface;
+    double spot = ticker.getSpotPrice();
+
+    // gather the OTM smile of every expiration from the slices, which are in time order
+    const auto &options = ticker.getOptions();
+    std::vector<Smile> rows;
+    for (const ExpirySlice &slice : ticker.getSlices())
+    {
+        const ParityFit *fit = ticker.findParityFit(slice.expiration);
+        double forward = fit ? fit->forward
+                             : spot * std::exp(ticker.getInterestRate() * slice.timeToMaturity);
+        Smile smile{slice.timeToMaturity, forward, {}};
+
+        for (size_t i = slice.callBegin; i < slice.end; ++i)
+        {
+            const OptionData &option = *options[i];
+            double k = std::log(option.strike / smile.forward);
+            bool outOfTheMoney = (i < slice.putBegin) == (k >= 0);
+            double iv = option.implied_vol();
+
+            if (outOfTheMoney && option.bid > 0 && option.ask > 0 && iv > min_iv && iv < max_iv)
+            {
+                smile.points.emplace_back(k, iv * iv * smile.timeToMaturity);
+            }
+        }
+
+        std::sort(smile.points.begin(), smile.points.end());
+        smile.points.erase(std::unique(smile.points.begin(), smile.points.end(),
+                                       [](const auto &a, const auto &b)
+                                       { return a.first == b.first; }),
+                           smile.points.end());
+        if (smile.points.size() >= min_quotes && smile.timeToMaturity > 0)
+        {
+            rows.push_back(std::move(smile));
+        }
+    }
+    if (rows.empty() || num_strikes < 3)
+    {
+        return surface;
+    }
+
+    // log-moneyness grid spanning the quoted strikes of all expirations
+    double kMin = 0, kMax = 0;
+    for (const auto &row : rows)
+    {
+        kMin = std::min(kMin, row.points.front().first);
+        kMax = std::max(kMax, row.points.back().first);
+    }
+    kMin = std::max(kMin, -1.5);
+    kMax = std::min(kMax, 1.5);
+    double dk = (kMax - kMin) / (num_strikes - 1);
+    if (dk <= 0)
+    {
+        return surface;
+    }
+
+    size_t nT = rows.size();
+    surface.logMoneyness_.resize(num_strikes);
+    for (size_t i = 0; i < num_strikes; ++i)
+    {
+        surface.logMoneyness_[i] = kMin + i * dk;
+    }
+
+    // total variance rows: interpolate, smooth, then remove calendar arbitrage
+    surface.totalVariance_.resize(nT * num_strikes);
+    std::vector<double> smoothed(num_strikes);
+    for (size_t j = 0; j < nT; ++j)
+    {
+        surface.expiries_.push_back(rows[j].timeToMaturity);
+        surface.forwards_.push_back(rows[j].forward);
+
+        double *w = &surface.totalVariance_[j * num_strikes];
+        for (size_t i = 0; i < num_strikes; ++i)
+        {
+            w[i] = interpolate_points(rows[j].points, surface.logMoneyness_[i]);
+        }
+
+        for (int pass = 0; pass < smoothing_passes; ++pass)
+        {
+            smoothed[0] = w[0];
+            smoothed[num_strikes - 1] = w[num_strikes - 1];
+            for (size_t i = 1; i + 1 < num_strikes; ++i)
+            {
+                smoothed[i] = 0.25 * (w[i - 1] + 2 * w[i] + w[i + 1]);
+            }
+            std::copy(smoothed.begin(), smoothed.end(), w);
+        }
+
+        // total variance must not decrease with maturity
+        if (j > 0)
+        {
+            const double *prev = &surface.totalVariance_[(j - 1) * num_strikes];
+            for (size_t i = 0; i < num_strikes; ++i)
+            {
+                w[i] = std::max(w[i], prev[i] * (1 + 1e-6));
+            }
+        }
+    }
+
+    // Dupire local variance in terms of total implied variance (Gatheral):
+    // sigma_loc^2 = w_T / (1 - k / w * w_k + 1/4 * (-1/4 - 1/w + k^2 / w^2) * w_k^2 + 1/2 * w_kk)
+    surface.localVariance_.resize(nT * num_strikes);
+    for (size_t j = 0; j < nT; ++j)
+    {
+        const double *w = &surface.totalVariance_[j * num_strikes];
+        const double *prev = j > 0 ? &surface.totalVariance_[(j - 1) * num_strikes] : nullptr;
+        double dT = j > 0 ? surface.expiries_[j] - surface.expiries_[j - 1] : surface.expiries_[0];
+
+        for (size_t i = 0; i < num_strikes; ++i)
+        {
+            double k = surface.logMoneyness_[i];
+            size_t left = i > 0 ? i - 1 : i;
+            size_t right = i + 1 < num_strikes ? i + 1 : i;
+            double wk = (w[right] - w[left]) / ((right - left) * dk);
+            double wkk = (left < i && i < right) ? (w[right] - 2 * w[i] + w[left]) / (dk * dk) : 0.0;
+            double wT = (w[i] - (prev ? prev[i] : 0.0)) / dT;
+
+            double denom = 1 - k / w[i] * wk + 0.25 * (-0.25 - 1 / w[i] + k * k / (w[i] * w[i])) * wk * wk + 0.5 * wkk;
+            double localVariance = wT / denom;
+
+            // fall back to the implied variance where the formula breaks down
+            if (!(denom > 0) || !std::isfinite(localVariance) || localVariance <= 0)
+            {
+                localVariance = w[i] / surface.expiries_[j];
+            }
+            surface.localVariance_[j * num_strikes + i] = std::clamp(localVariance, min_local_variance, max_local_variance);
+        }
+    }
+
+    return surface;
+}
+
+// linear interpolation along the log-moneyness grid of one row, flat outside it
+double LocalVolSurface::interpolate_row_(const std::vector<double> &grid, size_t expiry, double k) const
+{
+    size_t n = logMoneyness_.size();
+    const double *row = &grid[expiry * n];
+    double dk = logMoneyness_[1] - logMoneyness_[0];
+    double pos = (k - logMoneyness_[0]) / dk;
+
+    if (pos <= 0)
+        return row[0];
+    if (pos >= n - 1)
+        return row[n - 1];
+
+    size_t i = static_cast<size_t>(pos);
+    double weight = pos - i;
+    return row[i] + weight * (row[i + 1] - row[i]);
+}
+
+size_t LocalVolSurface::expiry_index(double t) const
+{
+    auto it = std::lower_bound(expiries_.begin(), expiries_.end(), t);
+    return it == expiries_.end() ? expiries_.size() - 1 : static_cast<size_t>(it - expiries_.begin());
+}
+
+double LocalVolSurface::local_variance(size_t expiry, double spot) const
+{
+    return interpolate_row_(localVariance_, expiry, std::log(spot / forwards_[expiry]));
+}
+
+double LocalVolSurface::local_vol(double t, double spot) const
+{
+    return std::sqrt(local_variance(expiry_index(t), spot));
+}
+
+double LocalVolSurface::implied_vol(size_t expiry, double strike) const
+{
+    double w = interpolate_row_(totalVariance_, expiry, std::log(strike / forwards_[expiry]));
+    return std::sqrt(w / expiries_[expiry]);
+}
+
+void solve_tridiagonal(const std::vector<double> &lower, const std::vector<double> &diag,
+                       const std::vector<double> &upper, std::vector<double> &rhs,
+                       std::vector<double> &scratch)
+{
+    size_t n = diag.size();
+    scratch.resize(n);
+
+    // forward sweep
+    scratch[0] = upper[0] / diag[0];
+    rhs[0] = rhs[0] / diag[0];
+    for (size_t i = 1; i < n; ++i)
+    {
+        double m = 1.0 / (diag[i] - lower[i] * scratch[i - 1]);
+        scratch[i] = upper[i] * m;
+        rhs[i] = (rhs[i] - lower[i] * rhs[i - 1]) * m;
+    }
+
+    // back substitution
+    for (size_t i = n - 1; i-- > 0;)
+    {
+        rhs[i] -= scratch[i] * rhs[i + 1];
+    }
+}
+
+CrankNicolsonPricer::CrankNicolsonPricer(const LocalVolSurface &surface, double spot,
+                                         size_t space_steps, size_t time_steps)
+    : surface_(surface), spot_(spot), space_steps_(space_steps), time_steps_(time_steps) {}
+
+double CrankNicolsonPricer::operator()(const PdeContract &contract) const
+{
+    double T = contract.maturity;
+    double K = contract.strike;
+    double r = contract.interestRate;
+    double q = contract.dividendYield;
+    int phi = static_cast<int>(contract.payoffType);
+
+    if (spot_ <= contract.lowerBarrier || spot_ >= contract.upperBarrier)
+    {
+        return 0.0; // already knocked out
+    }
+
+    // log-spot grid wide enough for five standard deviations and the strike, cut at the barriers
+    size_t row = surface_.expiry_index(T);
+    double sigma = surface_.implied_vol(row, K);
+    double width = std::max(5 * sigma * std::sqrt(T), 0.25);
+    double x0 = std::log(spot_);
+    double xMin = std::min(x0 - width, std::log(K) - 0.1);
+    double xMax = std::max(x0 + width, std::log(K) + 0.1);
+    bool lowerKnockOut = contract.lowerBarrier > 0;
+    bool upperKnockOut = std::isfinite(contract.upperBarrier);
+    if (lowerKnockOut)
+        xMin = std::log(contract.lowerBarrier);
+    if (upperKnockOut)
+        xMax = std::log(contract.upperBarrier);
+
+    size_t N = space_steps_;
+    double dx = (xMax - xMin) / N;
+
+    std::vector<double> x(N + 1), s(N + 1), value(N + 1);
+    for (size_t i = 0; i <= N; ++i)
+    {
+        x[i] = xMin + i * dx;
+        s[i] = std::exp(x[i]);
+        value[i] = std::max(phi * (s[i] - K), 0.0);
+    }
+
+    // banded storage of the implicit system plus the explicit operator coefficients
+    std::vector<double> lower(N + 1), diag(N + 1), upper(N + 1), rhs(N + 1), scratch;
+    std::vector<double> opLower(N + 1), opDiag(N + 1), opUpper(N + 1);
+    size_t cachedRow = static_cast<size_t>(-1);
+
+    // Rannacher start-up: four implicit half steps damp the payoff kink, then Crank-Nicolson
+    size_t startup = std::min<size_t>(4, 2 * time_steps_);
+    double fullStep = T / time_steps_;
+    double tau = 0.0;
+
+    for (size_t step = 0; tau < T - 1e-14; ++step)
+    {
+        bool implicitStep = step < startup;
+        double dt = std::min(implicitStep ? 0.5 * fullStep : fullStep, T - tau);
+        double theta = implicitStep ? 1.0 : 0.5;
+        double tauNew = tau + dt;
+
+        // the local vol is piecewise constant in time, rebuild the operator only when its row changes
+        size_t volRow = surface_.expiry_index(T - (tau + 0.5 * dt));
+        if (volRow != cachedRow)
+        {
+            for (size_t i = 1; i < N; ++i)
+            {
+                double variance = surface_.local_variance(volRow, s[i]);
+                double a = 0.5 * variance / (dx * dx);
+                double b = (r - q - 0.5 * variance) / (2 * dx);
+                opLower[i] = a - b;
+                opDiag[i] = -2 * a - r;
+                opUpper[i] = a + b;
+            }
+            cachedRow = volRow;
+        }
+
+        for (size_t i = 1; i < N; ++i)
+        {
+            lower[i] = -theta * dt * opLower[i];
+            diag[i] = 1 - theta * dt * opDiag[i];
+            upper[i] = -theta * dt * opUpper[i];
+            rhs[i] = value[i] + (1 - theta) * dt * (opLower[i] * value[i - 1] + opDiag[i] * value[i] + opUpper[i] * value[i + 1]);
+        }
+
+        // Dirichlet boundaries: zero at a barrier, otherwise the discounted intrinsic value
+        double discount = std::exp(-r * tauNew);
+        double dividend = std::exp(-q * tauNew);
+        lower[0] = upper[0] = 0;
+        diag[0] = 1;
+        rhs[0] = lowerKnockOut ? 0.0 : std::max(phi * (s[0] * dividend - K * discount), 0.0);
+        lower[N] = upper[N] = 0;
+        diag[N] = 1;
+        rhs[N] = upperKnockOut ? 0.0 : std::max(phi * (s[N] * dividend - K * discount), 0.0);
+
+        solve_tridiagonal(lower, diag, upper, rhs, scratch);
+        value.swap(rhs);
+        tau = tauNew;
+    }
+
+    // linear interpolation at today's spot
+    double pos = (x0 - xMin) / dx;
+    size_t i = std::min(static_cast<size_t>(pos), N - 1);
+    double weight = pos - i;
+    return value[i] + weight * (value[i + 1] - value[i]);
+}
+
+std::vector<double> CrankNicolsonPricer::price_all(const std::vector<PdeContract> &contracts) const
+{
+    std::vector<double> prices(contracts.size());
+    parallel_for(contracts.size(), [&](size_t begin, size_t end)
+                 {
+                     for (size_t i = begin; i < end; ++i)
+                     {
+                         prices[i] = (*this)(contracts[i]);
+                     } },
+                 16);
+    return prices;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <limits>
+#include <vector>
+#include "BlackScholes.h"
+#include "Ticker.h"
+
+// Dupire local volatility surface extracted from the solved implied vols of a Ticker
+// the surface is stored on a (expiry, log-moneyness) grid, one row per expiration
+class LocalVolSurface
+{
+public:
+    // build from the bisection IVs of the chain, put-call parity should be calculated first
+    // so every expiration has an implied forward; returns an empty surface if no expiry has enough quotes
+    static LocalVolSurface from_ticker(const Ticker &ticker, size_t num_strikes = 101);
+
+    bool empty() const { return expiries_.empty(); }
+
+    // local vol at calendar time t and spot level S
+    double local_vol(double t, double spot) const;
+    // row holding calendar time t, local variance is piecewise constant in time between expirations
+    size_t expiry_index(double t) const;
+    double local_variance(size_t expiry, double spot) const;
+    // implied vol of the smoothed input surface at an expiration row and strike
+    double implied_vol(size_t expiry, double strike) const;
+
+    size_t num_expiries() const { return expiries_.size(); }
+    double expiry_time(size_t expiry) const { return expiries_[expiry]; }
+    double forward(size_t expiry) const { return forwards_[expiry]; }
+
+private:
+    double interpolate_row_(const std::vector<double> &grid, size_t expiry, double k) const;
+
+    std::vector<double> expiries_;      // expiration times, increasing
+    std::vector<double> forwards_;      // implied forward of each expiration
+    std::vector<double> logMoneyness_;  // k = ln(K / F) grid shared by all rows
+    std::vector<double> totalVariance_; // w(T, k) = IV^2 * T, row major by expiry
+    std::vector<double> localVariance_; // sigma_loc^2(T, k), row major by expiry
+};
+
+// contract priced by the Crank-Nicolson pricer, a vanilla european or a knock-out barrier
+struct PdeContract
+{
+    double strike;
+    double maturity;
+    PayoffType payoffType;
+    double interestRate;
+    double dividendYield;
+    double lowerBarrier = 0;                                         // knocked out at or below, 0 for none
+    double upperBarrier = std::numeric_limits<double>::infinity();   // knocked out at or above
+};
+
+// Crank-Nicolson finite difference pricer for dV/dt + (r - q - sigma^2 / 2) V_x + sigma^2 / 2 V_xx - r V = 0
+// in x = ln S under a local vol surface, with Rannacher (implicit Euler) start-up steps
+class CrankNicolsonPricer
+{
+public:
+    CrankNicolsonPricer(const LocalVolSurface &surface, double spot,
+                        size_t space_steps = 200, size_t time_steps = 100);
+
+    double operator()(const PdeContract &contract) const;
+
+    // price many contracts across worker threads
+    std::vector<double> price_all(const std::vector<PdeContract> &contracts) const;
+
+private:
+    const LocalVolSurface &surface_;
+    double spot_;
+    size_t space_steps_, time_steps_;
+};
+
+// solve a tridiagonal system in banded storage with the Thomas algorithm
+// lower[0] and upper[n - 1] are ignored, rhs is overwritten with the solution
+void solve_tridiagonal(const std::vector<double> &lower, const std::vector<double> &diag,
+                       const std::vector<double> &upper, std::vector<double> &rhs,
+                       std::vector<double> &scratch);
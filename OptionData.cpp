@@ -3,8 +3,31 @@
 #include <cmath>
 #include "BlackScholes.h"
 
+namespace
+{
+    IVSettings ivSettings;
+}
+
+void set_iv_settings(const IVSettings &settings)
+{
+    ivSettings = settings;
+}
+
+const IVSettings &iv_settings()
+{
+    return ivSettings;
+}
+
 // implementation of calculate iv and greeks
-void OptionData::calculate_iv_and_greeks(double spotPrice, double interestRate)
+void OptionData::calculate_iv_and_greeks(double spotPrice, double interestRate, double dividendYield, double initialVol)
+{
+    // Create Black-Scholes model instance
+    BlackScholes bs(strike, spotPrice, timeToMaturity, interestRate,
+                    (optionType == "Call" ? PayoffType::Call : PayoffType::Put), dividendYield);
+    calculate_iv_and_greeks(bs, initialVol);
+}
+
+void OptionData::calculate_iv_and_greeks(BlackScholes &bs, double initialVol)
 {
     // Skip calculation if lastPrice, bid, and ask are all zero
     if ((lastPrice <= 0.0 || std::isnan(lastPrice)) &&
@@ -15,41 +38,62 @@ void OptionData::calculate_iv_and_greeks(double spotPrice, double interestRate)
     }
 
     // Use mid-price if bid/ask exist, otherwise use last price
-    double market_price = (bid > 0 && ask > 0) ? (bid + ask) / 2 : lastPrice;
-
-    // Create Black-Scholes model instance
-    BlackScholes bs(strike, spotPrice, timeToMaturity, interestRate,
-                    (optionType == "Call" ? PayoffType::Call : PayoffType::Put));
+    double market_price = this->market_price();
 
     // std::cout << bs << std::endl;
     // std::cout << "Finding root with market price: " << market_price << std::endl;
-    // Measure time for Bisection Method
-    auto start_bisect = std::chrono::high_resolution_clock::now();
-    bisectionImpliedVol = bisection_method(bs, market_price);
-    auto end_bisect = std::chrono::high_resolution_clock::now();
-    bisectionTime = std::chrono::duration<double, std::milli>(end_bisect - start_bisect).count();
-
-    // Measure time for Newton's Method
-    auto start_newton = std::chrono::high_resolution_clock::now();
-    newtonImpliedVol = newton_method(bs, market_price);
-    auto end_newton = std::chrono::high_resolution_clock::now();
-    newtonTime = std::chrono::duration<double, std::milli>(end_newton - start_newton).count();
-
-    // Measure time for Secant Method
-    auto start_secant = std::chrono::high_resolution_clock::now();
-    secantImpliedVol = secant_method(bs, market_price);
-    auto end_secant = std::chrono::high_resolution_clock::now();
-    secantTime = std::chrono::duration<double, std::milli>(end_secant - start_secant).count();
+    const IVSettings &settings = iv_settings();
+
+    // run one solver, with its wall clock time in milliseconds if timing is on
+    auto run = [&settings](auto solve, double &iv, double &time)
+    {
+        if (!settings.timing)
+        {
+            iv = solve();
+            return;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        iv = solve();
+        auto end = std::chrono::high_resolution_clock::now();
+        time = std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    // Bisection Method
+    if (settings.bisection)
+        run([&]
+            { return bisection_method(bs, market_price, false, initialVol); }, bisectionImpliedVol, bisectionTime);
+
+    // Newton's Method
+    if (settings.newton)
+        run([&]
+            { return initialVol > 0 ? newton_method(bs, market_price, initialVol) : newton_method(bs, market_price); }, newtonImpliedVol, newtonTime);
+
+    // Secant Method
+    if (settings.secant)
+        run([&]
+            { return initialVol > 0 ? secant_method(bs, market_price, initialVol) : secant_method(bs, market_price); }, secantImpliedVol, secantTime);
+
+    double vol = implied_vol();
+    if (vol <= 0)
+    {
+        return;
+    }
 
     // calculating greeks using BlackScholes derivation
-    delta_bs = bs.get_delta(bisectionImpliedVol);
-    gamma_bs = bs.get_gamma(bisectionImpliedVol);
-    vega_bs = bs.get_vega(bisectionImpliedVol);
+    if (settings.analyticGreeks)
+    {
+        delta_bs = bs.get_delta(vol);
+        gamma_bs = bs.get_gamma(vol);
+        vega_bs = bs.get_vega(vol);
+    }
 
     // calculating greeks using Finite Difference method
-    delta_fd = delta_finite_difference(bs, bisectionImpliedVol);
-    gamma_fd = gamma_finite_difference(bs, bisectionImpliedVol);
-    vega_fd = vega_finite_difference(bs, bisectionImpliedVol);
+    if (settings.finiteDifferenceGreeks)
+    {
+        delta_fd = delta_finite_difference(bs, vol);
+        gamma_fd = gamma_finite_difference(bs, vol);
+        vega_fd = vega_finite_difference(bs, vol);
+    }
 }
 
 void OptionData::calculate_bs_price(double spot, double rate, double vol)
@@ -58,4 +102,22 @@ void OptionData::calculate_bs_price(double spot, double rate, double vol)
                           (optionType == "Call" ? PayoffType::Call : PayoffType::Put), 0.02);
 
     bs_price = bs_model(vol);
+}
+
+void OptionData::calculate_bs_price(const BlackScholes &model, double vol)
+{
+    bs_price = model(vol);
+}
+
+uint64_t OptionData::quote_hash(double spotPrice, double interestRate, double dividendYield) const
+{
+    // FNV-1a over the bit patterns of the solver inputs
+    const double inputs[] = {spotPrice, interestRate, dividendYield, timeToMaturity, strike, lastPrice, bid, ask};
+    uint64_t hash = 14695981039346656037ull;
+    const auto *bytes = reinterpret_cast<const unsigned char *>(inputs);
+    for (size_t i = 0; i < sizeof(inputs); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
 }
\ No newline at end of file
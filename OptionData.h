@@ -3,7 +3,19 @@
 
 #include <string>
 #include "util.h"
+#include "BlackScholes.h"
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// what the options of a chain are written on: Equity chains are priced with Black-Scholes on the spot,
+// Index chains (cash indices and VIX, whose hedge is the future) with Black-76 on the per-expiry forward
+enum class UnderlyingType
+{
+  Equity,
+  Index
+};
 
 // struct to hold all the information of the option chain and the calculated IVs and Greeks
 struct OptionData
@@ -42,16 +54,94 @@ struct OptionData
   double parity_price;
   double bs_price;
 
+  // (C - P) - D * (F - K) from the parity fit of this expiration
+  double parity_residual;
+
   // Constructor for initialization
   OptionData(const std::string &exp, double ttm, double strk, const std::string &type,
              double lp, double b, double a, double vol, double oi, double iv, bool itm)
       : expiration(exp), timeToMaturity(ttm), strike(strk), optionType(type),
         lastPrice(lp), bid(b), ask(a), volume(vol), openInterest(oi),
-        impliedVolatility(iv), inTheMoney(itm), bisectionImpliedVol(0), newtonImpliedVol(0), bisectionTime(0), newtonTime(0),
-        delta_bs(0), gamma_bs(0), vega_bs(0), delta_fd(0), gamma_fd(0), vega_fd(0) {}
+        impliedVolatility(iv), inTheMoney(itm), bisectionImpliedVol(0), newtonImpliedVol(0), secantImpliedVol(0), bisectionTime(0), newtonTime(0), secantTime(0),
+        delta_bs(0), gamma_bs(0), vega_bs(0), delta_fd(0), gamma_fd(0), vega_fd(0),
+        parity_price(0), bs_price(0), parity_residual(0) {}
 
-  void calculate_iv_and_greeks(double spotPrice, double interestRate);
+  // mid-price if bid/ask exist, otherwise last price
+  double market_price() const { return (bid > 0 && ask > 0) ? (bid + ask) / 2 : lastPrice; }
+
+  // hash of every input the IV solve depends on, used to detect unchanged quotes between runs
+  uint64_t quote_hash(double spotPrice, double interestRate, double dividendYield) const;
+
+  // the IV the greeks and the downstream models use: bisection, or the first other solver that ran
+  double implied_vol() const
+  {
+    if (bisectionImpliedVol > 0)
+      return bisectionImpliedVol;
+    return newtonImpliedVol > 0 ? newtonImpliedVol : secantImpliedVol;
+  }
+
+  // initialVol > 0 warm-starts the selected solvers from a previously solved IV
+  void calculate_iv_and_greeks(double spotPrice, double interestRate, double dividendYield = 0, double initialVol = 0);
+  // the same under a given pricing model, e.g. BlackScholes::black76 for index options
+  void calculate_iv_and_greeks(BlackScholes &model, double initialVol = 0);
   void calculate_bs_price(double spot, double rate, double vol);
+  // the same under a given pricing model, the one the IV was solved under
+  void calculate_bs_price(const BlackScholes &model, double vol);
+};
+
+// which solvers and greek methods calculate_iv_and_greeks runs, the columns of the others stay 0
+struct IVSettings
+{
+  bool bisection = true;
+  bool newton = true;
+  bool secant = true;
+  bool analyticGreeks = true;
+  bool finiteDifferenceGreeks = true;
+  // per-contract wall clock timing of the solvers, off by default so repeated runs write identical
+  // output (the time columns stay 0); use benchmark_solvers in SolverBenchmark.h to compare the solvers
+  bool timing = false;
+  // equity chains are solved as American options under this approximation (American.h), European by default
+  EarlyExercise american = EarlyExercise::None;
+
+  // bit per disabled solver or greek method and the early exercise approximation, 0 for the defaults
+  uint64_t disabled_mask() const
+  {
+    return uint64_t{!bisection} | uint64_t{!newton} << 1 | uint64_t{!secant} << 2 | uint64_t{!analyticGreeks} << 3 |
+           uint64_t{!finiteDifferenceGreeks} << 4 | static_cast<uint64_t>(american) << 5;
+  }
 };
 
+// process-wide settings, set once before the chains are solved
+void set_iv_settings(const IVSettings &settings);
+const IVSettings &iv_settings();
+
+// 64 bit FNV-1a hash identifying a contract by ticker, expiration, strike and type
+inline uint64_t contract_hash(std::string_view ticker, std::string_view expiration,
+                              double strike, std::string_view optionType)
+{
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](const void *data, size_t size)
+  {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+  };
+
+  mix(ticker.data(), ticker.size());
+  mix("|", 1);
+  mix(expiration.data(), expiration.size());
+  mix("|", 1);
+  mix(optionType.data(), optionType.size());
+  mix("|", 1);
+
+  // hash the bit pattern of the strike, normalising -0.0 to 0.0
+  uint64_t bits;
+  strike = strike + 0.0;
+  std::memcpy(&bits, &strike, sizeof(bits));
+  mix(&bits, sizeof(bits));
+  return hash;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// number of worker threads used by parallel_for, 0 means one per hardware thread
+inline std::atomic<unsigned> &parallel_thread_setting()
+{
+    static std::atomic<unsigned> threads{0};
+    return threads;
+}
+
+inline void set_parallel_threads(unsigned threads)
+{
+    parallel_thread_setting().store(threads);
+}
+
+inline unsigned parallel_threads()
+{
+    unsigned threads = parallel_thread_setting().load();
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// run body(begin, end) over [0, n) in chunks of at most grain items; the worker threads
+// pull chunks off a shared counter so uneven chunk costs still balance out
+template <typename Body>
+void parallel_for(size_t n, Body body, size_t grain = 1)
+{
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (n + grain - 1) / grain;
+    unsigned threads = static_cast<unsigned>(std::min<size_t>(parallel_threads(), chunks));
+
+    if (threads <= 1)
+    {
+        if (n > 0)
+        {
+            body(size_t{0}, n);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]
+    {
+        for (size_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1))
+        {
+            size_t begin = chunk * grain;
+            body(begin, std::min(n, begin + grain));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        workers.emplace_back(worker);
+    }
+    worker(); // the calling thread works too
+    for (auto &thread : workers)
+    {
+        thread.join();
+    }
+}
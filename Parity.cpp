@@ -0,0 +1,141 @@
+#include "Parity.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // weighted least squares fit of y = a + b * x, returns false if the system is singular
+    bool weighted_line_fit(const std::vector<double> &x, const std::vector<double> &y,
+                           const std::vector<double> &w, double &a, double &b)
+    {
+        double sw = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            sw += w[i];
+            sx += w[i] * x[i];
+            sy += w[i] * y[i];
+            sxx += w[i] * x[i] * x[i];
+            sxy += w[i] * x[i] * y[i];
+        }
+
+        double det = sw * sxx - sx * sx;
+        if (sw <= 0 || std::abs(det) <= 1e-12 * sw * sxx)
+        {
+            return false;
+        }
+
+        b = (sw * sxy - sx * sy) / det;
+        a = (sy - b * sx) / sw;
+        return true;
+    }
+
+    // median of a copy of the values
+    double median(std::vector<double> values)
+    {
+        size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        return values[mid];
+    }
+}
+
+ParityFit fit_parity(const std::vector<double> &strikes, const std::vector<double> &callPutSpread,
+                     double spot, double timeToMaturity, double interestRate)
+{
+    // Huber tuning constant and the iteration cap of the reweighting loop
+    constexpr double huber_c = 1.345;
+    constexpr int max_iter = 20;
+
+    ParityFit fit;
+    fit.timeToMaturity = timeToMaturity;
+    // keep strikes within a factor of two of spot, far wings are often stale or mislabeled quotes
+    std::vector<double> x, y;
+    x.reserve(strikes.size());
+    y.reserve(strikes.size());
+    for (size_t i = 0; i < strikes.size(); ++i)
+    {
+        if (strikes[i] >= 0.5 * spot && strikes[i] <= 2.0 * spot)
+        {
+            x.push_back(strikes[i]);
+            y.push_back(callPutSpread[i]);
+        }
+    }
+
+    size_t n = x.size();
+    fit.pairs = n;
+    double a = 0, b = 0;
+    std::vector<double> weights(n, 1.0);
+    std::vector<double> absResiduals(n);
+
+    // start from ordinary least squares and reweight the outliers (iteratively reweighted least squares)
+    bool ok = n >= 3 && weighted_line_fit(x, y, weights, a, b);
+    for (int iter = 0; ok && iter < max_iter; ++iter)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            absResiduals[i] = std::abs(y[i] - (a + b * x[i]));
+        }
+
+        // robust scale estimate from the median absolute residual
+        double scale = 1.4826 * median(absResiduals);
+        if (scale <= 0)
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            double u = absResiduals[i] / (huber_c * scale);
+            weights[i] = u <= 1 ? 1.0 : 1.0 / u;
+        }
+
+        double prev_a = a, prev_b = b;
+        ok = weighted_line_fit(x, y, weights, a, b);
+        if (std::abs(a - prev_a) <= 1e-10 * std::abs(a) && std::abs(b - prev_b) <= 1e-10 * std::abs(b))
+        {
+            break;
+        }
+    }
+
+    // C - P = D * F - D * K, so the slope is -D and the intercept is D * F
+    double discount = -b;
+    double forward = discount > 0 ? a / discount : 0;
+
+    // only accept fits whose implied rate is within 300bp of the flat rate, early exercise premia
+    // in american chains can bias the slope
+    if (ok && discount > 0 && forward > 0)
+    {
+        double rate = -std::log(discount) / timeToMaturity;
+        ok = std::abs(rate - interestRate) < 0.03;
+    }
+    else
+    {
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        // fall back to the flat rate and the median forward implied by each pair
+        discount = std::exp(-interestRate * timeToMaturity);
+        if (n > 0)
+        {
+            std::vector<double> forwards(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                forwards[i] = y[i] / discount + x[i];
+            }
+            forward = median(forwards);
+        }
+
+        if (forward <= 0)
+        {
+            forward = spot * std::exp(interestRate * timeToMaturity);
+        }
+    }
+
+    fit.discountFactor = discount;
+    fit.forward = forward;
+    fit.impliedRate = -std::log(discount) / timeToMaturity;
+    fit.impliedDividend = fit.impliedRate - std::log(forward / spot) / timeToMaturity;
+    fit.robust = ok;
+    return fit;
+}
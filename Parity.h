@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// forward and discount factor implied by put-call parity for one expiration
+struct ParityFit
+{
+    std::string expiration;
+    double timeToMaturity = 0;
+    double forward = 0;         // implied forward F
+    double discountFactor = 1;  // implied discount factor D
+    double impliedRate = 0;     // -ln(D) / T
+    double impliedDividend = 0; // implied borrow/dividend yield so that F = S * e^((r - q)T)
+    size_t pairs = 0;           // number of call/put pairs used in the fit
+    bool robust = false;        // false when the fit fell back to the flat rate
+};
+
+// fit C - P = D * (F - K) over one expiration by Huber-weighted least squares
+// strikes and callPutSpread (C - P from mid prices) must have the same length
+ParityFit fit_parity(const std::vector<double> &strikes, const std::vector<double> &callPutSpread,
+                     double spot, double timeToMaturity, double interestRate);
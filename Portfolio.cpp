@@ -0,0 +1,347 @@
+#include "Portfolio.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    // add the contribution of one position to a bucket
+    void accumulate(RiskTotals &totals, double delta, double gamma, double vega, double sign)
+    {
+        totals.dollarDelta += sign * delta;
+        totals.dollarGamma += sign * gamma;
+        totals.dollarVega += sign * vega;
+    }
+
+    void merge(std::vector<RiskTotals> &into, const std::vector<RiskTotals> &from)
+    {
+        for (size_t b = 0; b < from.size(); ++b)
+        {
+            into[b].dollarDelta += from[b].dollarDelta;
+            into[b].dollarGamma += from[b].dollarGamma;
+            into[b].dollarVega += from[b].dollarVega;
+            into[b].positions += from[b].positions;
+        }
+    }
+
+    // label of a moneyness bucket, e.g. "0.95-1" or ">=1.2"
+    std::string moneyness_label(size_t bucket)
+    {
+        std::ostringstream label;
+        if (bucket == 0)
+            label << "<" << Portfolio::moneyness_edges[0];
+        else if (bucket == Portfolio::num_moneyness_buckets - 1)
+            label << ">=" << Portfolio::moneyness_edges[bucket - 1];
+        else
+            label << Portfolio::moneyness_edges[bucket - 1] << "-" << Portfolio::moneyness_edges[bucket];
+        return label.str();
+    }
+}
+
+size_t Portfolio::load_positions(const std::string &filename,
+                                 const std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers)
+{
+    std::vector<PositionRow> rows = read_positions(filename);
+
+    // index the loaded contracts once instead of searching a chain per position
+    std::unordered_map<uint64_t, std::pair<const Ticker *, const OptionData *>> contracts;
+    for (const auto &[name, ticker] : tickers)
+    {
+        for (const auto &option : ticker->getOptions())
+        {
+            contracts.emplace(contract_hash(name, option->expiration, option->strike, option->optionType),
+                              std::make_pair(ticker.get(), option.get()));
+        }
+    }
+
+    size_t skipped = 0;
+    size_t added = add_rows_(rows, contracts, skipped);
+    if (skipped > 0)
+    {
+        std::cerr << "Warning: skipped " << skipped << " positions in contracts that are not loaded" << std::endl;
+    }
+    return added;
+}
+
+std::vector<PositionRow> Portfolio::read_positions(const std::string &filename)
+{
+    std::vector<PositionRow> rows;
+    std::ifstream ifile(filename);
+    if (!ifile.is_open())
+    {
+        std::cerr << "Error: Unable to open positions file " << filename << std::endl;
+        return rows;
+    }
+
+    std::string line, temp;
+    PositionRow row;
+
+    // getting rid of headers
+    std::getline(ifile, line);
+
+    while (std::getline(ifile, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        std::stringstream ss(line);
+        std::getline(ss, row.ticker, ',');
+        std::getline(ss, row.expiration, ',');
+        try
+        {
+            std::getline(ss, temp, ',');
+            row.strike = std::stod(temp);
+            std::getline(ss, row.optionType, ',');
+            std::getline(ss, temp, ',');
+            row.quantity = std::stod(temp);
+        }
+        catch (const std::exception &)
+        {
+            std::cerr << "Error: skipping position row " << line << std::endl;
+            continue;
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+size_t Portfolio::add_positions(const std::vector<PositionRow> &rows, const Ticker &ticker)
+{
+    std::unordered_map<uint64_t, std::pair<const Ticker *, const OptionData *>> contracts;
+    for (const auto &option : ticker.getOptions())
+    {
+        contracts.emplace(contract_hash(ticker.getTickerName(), option->expiration, option->strike, option->optionType),
+                          std::make_pair(&ticker, option.get()));
+    }
+    size_t skipped = 0;
+    return add_rows_(rows, contracts, skipped);
+}
+
+size_t Portfolio::add_rows_(const std::vector<PositionRow> &rows,
+                            const std::unordered_map<uint64_t, std::pair<const Ticker *, const OptionData *>> &contracts,
+                            size_t &skipped)
+{
+    size_t added = 0;
+    for (const PositionRow &row : rows)
+    {
+        auto it = contracts.find(contract_hash(row.ticker, row.expiration, row.strike, row.optionType));
+        if (it != contracts.end() && add_position(*it->second.first, *it->second.second, row.quantity))
+        {
+            added++;
+        }
+        else
+        {
+            skipped++;
+        }
+    }
+    return added;
+}
+
+size_t Portfolio::expiry_bucket_(size_t tickerId, const std::string &expiration)
+{
+    std::string key = tickerNames_[tickerId] + "|" + expiration;
+    auto it = expiryIds_.find(key);
+    if (it != expiryIds_.end())
+    {
+        return it->second;
+    }
+    expiryBuckets_.emplace_back(tickerId, expiration);
+    expiryIds_.emplace(key, expiryBuckets_.size() - 1);
+    return expiryBuckets_.size() - 1;
+}
+
+bool Portfolio::add_position(const Ticker &ticker, const OptionData &option, double quantity)
+{
+    const std::string &name = ticker.getTickerName();
+    auto tickerIt = tickerIds_.find(name);
+    if (tickerIt == tickerIds_.end())
+    {
+        tickerNames_.push_back(name);
+        tickerIt = tickerIds_.emplace(name, tickerNames_.size() - 1).first;
+    }
+    size_t tickerId = tickerIt->second;
+
+    // index greeks are per unit of the expiry's forward, equity greeks per unit of the spot
+    double spot = ticker.pricing_model(option, ticker.getSpotPrice()).get_spot();
+    double moneyness = option.strike / spot;
+    size_t bucket = std::upper_bound(std::begin(moneyness_edges), std::end(moneyness_edges), moneyness) - std::begin(moneyness_edges);
+
+    uint64_t key = contract_hash(name, option.expiration, option.strike, option.optionType);
+    positionsByContract_.emplace(key, quantity_.size());
+    contract_.push_back(&option);
+    contractKey_.push_back(key);
+    quantity_.push_back(quantity);
+    spot_.push_back(spot);
+    tickerId_.push_back(static_cast<uint32_t>(tickerId));
+    expiryId_.push_back(static_cast<uint32_t>(expiry_bucket_(tickerId, option.expiration)));
+    moneynessId_.push_back(static_cast<uint32_t>(tickerId * num_moneyness_buckets + bucket));
+    dollarDelta_.push_back(0);
+    dollarGamma_.push_back(0);
+    dollarVega_.push_back(0);
+    return true;
+}
+
+void Portfolio::contribution_(size_t i, double &delta, double &gamma, double &vega) const
+{
+    const OptionData &option = *contract_[i];
+    double notional = quantity_[i] * contract_multiplier;
+    double spot = spot_[i];
+
+    // the analytic greeks when they were computed, otherwise the finite difference ones
+    bool analytic = iv_settings().analyticGreeks;
+    delta = notional * (analytic ? option.delta_bs : option.delta_fd) * spot;
+    gamma = notional * (analytic ? option.gamma_bs : option.gamma_fd) * spot * spot / 100;
+    vega = notional * (analytic ? option.vega_bs : option.vega_fd) / 100;
+}
+
+void Portfolio::aggregate()
+{
+    size_t n = size();
+    byTicker_.assign(tickerNames_.size(), {});
+    byExpiry_.assign(expiryBuckets_.size(), {});
+    byMoneyness_.assign(tickerNames_.size() * num_moneyness_buckets, {});
+
+    // fixed size chunks, each reduced into its own bucket arrays; the partials are summed in chunk order
+    // afterwards, so the totals do not depend on the thread count or on which worker ran which chunk
+    constexpr size_t grain = 4096;
+    struct Partial
+    {
+        std::vector<RiskTotals> tickers, expiries, moneyness;
+    };
+    std::vector<Partial> partials((n + grain - 1) / grain);
+
+    parallel_for(n, [&](size_t begin, size_t end)
+                 {
+        for (size_t c = begin / grain; c * grain < end; ++c)
+        {
+            Partial &partial = partials[c];
+            partial.tickers.assign(byTicker_.size(), {});
+            partial.expiries.assign(byExpiry_.size(), {});
+            partial.moneyness.assign(byMoneyness_.size(), {});
+            for (size_t i = c * grain; i < std::min(end, (c + 1) * grain); ++i)
+            {
+                if (contract_[i])
+                    contribution_(i, dollarDelta_[i], dollarGamma_[i], dollarVega_[i]);
+                accumulate(partial.tickers[tickerId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], 1.0);
+                accumulate(partial.expiries[expiryId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], 1.0);
+                accumulate(partial.moneyness[moneynessId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], 1.0);
+                partial.tickers[tickerId_[i]].positions++;
+                partial.expiries[expiryId_[i]].positions++;
+                partial.moneyness[moneynessId_[i]].positions++;
+            }
+        } },
+                 grain);
+
+    for (const Partial &partial : partials)
+    {
+        merge(byTicker_, partial.tickers);
+        merge(byExpiry_, partial.expiries);
+        merge(byMoneyness_, partial.moneyness);
+    }
+}
+
+void Portfolio::release_ticker(const std::string &ticker)
+{
+    auto it = tickerIds_.find(ticker);
+    if (it == tickerIds_.end())
+    {
+        return;
+    }
+    for (size_t i = 0; i < size(); ++i)
+    {
+        if (tickerId_[i] != it->second || !contract_[i])
+            continue;
+        contribution_(i, dollarDelta_[i], dollarGamma_[i], dollarVega_[i]);
+        contract_[i] = nullptr;
+    }
+    std::erase_if(positionsByContract_, [this](const auto &entry)
+                  { return !contract_[entry.second]; });
+}
+
+// add (sign = 1) or remove (sign = -1) the stored contribution of position i
+void Portfolio::apply_(size_t i, double sign)
+{
+    accumulate(byTicker_[tickerId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], sign);
+    accumulate(byExpiry_[expiryId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], sign);
+    accumulate(byMoneyness_[moneynessId_[i]], dollarDelta_[i], dollarGamma_[i], dollarVega_[i], sign);
+}
+
+void Portfolio::update_contracts(const std::vector<uint64_t> &contractKeys)
+{
+    // positions added since the last full aggregation have no buckets yet
+    if (byTicker_.size() != tickerNames_.size() || byExpiry_.size() != expiryBuckets_.size())
+    {
+        aggregate();
+        return;
+    }
+
+    for (uint64_t key : contractKeys)
+    {
+        auto [first, last] = positionsByContract_.equal_range(key);
+        for (auto it = first; it != last; ++it)
+        {
+            size_t i = it->second;
+            apply_(i, -1.0);
+            contribution_(i, dollarDelta_[i], dollarGamma_[i], dollarVega_[i]);
+            apply_(i, 1.0);
+        }
+    }
+}
+
+bool Portfolio::set_quantity(uint64_t contractKey, double quantity)
+{
+    auto [first, last] = positionsByContract_.equal_range(contractKey);
+    if (first == last)
+    {
+        return false;
+    }
+
+    for (auto it = first; it != last; ++it)
+    {
+        quantity_[it->second] = quantity;
+    }
+    update_contracts({contractKey});
+    return true;
+}
+
+const RiskTotals &Portfolio::ticker_totals(const std::string &ticker) const
+{
+    static const RiskTotals empty;
+    auto it = tickerIds_.find(ticker);
+    return (it == tickerIds_.end() || it->second >= byTicker_.size()) ? empty : byTicker_[it->second];
+}
+
+void Portfolio::write_report(const std::string &filename) const
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Unable to open file " << filename << std::endl;
+        return;
+    }
+
+    auto write_row = [&file](const std::string &level, const std::string &ticker, const std::string &bucket, const RiskTotals &totals)
+    {
+        file << level << "," << ticker << "," << bucket << "," << totals.positions << ","
+             << totals.dollarDelta << "," << totals.dollarGamma << "," << totals.dollarVega << "\n";
+    };
+
+    file << "Level,Ticker,Bucket,Positions,DollarDelta,DollarGamma,DollarVega\n";
+    for (size_t t = 0; t < byTicker_.size(); ++t)
+    {
+        write_row("Ticker", tickerNames_[t], "All", byTicker_[t]);
+    }
+    for (size_t e = 0; e < byExpiry_.size(); ++e)
+    {
+        if (byExpiry_[e].positions > 0)
+            write_row("Expiry", tickerNames_[expiryBuckets_[e].first], expiryBuckets_[e].second, byExpiry_[e]);
+    }
+    for (size_t m = 0; m < byMoneyness_.size(); ++m)
+    {
+        if (byMoneyness_[m].positions > 0)
+            write_row("Moneyness", tickerNames_[m / num_moneyness_buckets], moneyness_label(m % num_moneyness_buckets), byMoneyness_[m]);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Ticker.h"
+
+// position-weighted dollar greeks of one aggregation bucket
+struct RiskTotals
+{
+    double dollarDelta = 0; // quantity * multiplier * delta * S, S the underlying of the pricing model
+    double dollarGamma = 0; // quantity * multiplier * gamma * S^2 / 100, per 1% move in S
+    double dollarVega = 0;  // quantity * multiplier * vega / 100, per vol point
+    size_t positions = 0;
+};
+
+// one row of a positions csv
+struct PositionRow
+{
+    std::string ticker, expiration, optionType;
+    double strike, quantity;
+};
+
+// book of option positions aggregated by ticker, by ticker and expiration, and by ticker and
+// moneyness bucket; positions are held as columns so the rollups are plain parallel reductions
+class Portfolio
+{
+public:
+    static constexpr double contract_multiplier = 100;
+    // upper edges of the K / S moneyness buckets (S the spot, or the forward of an index expiry), the last bucket is open ended
+    static constexpr double moneyness_edges[] = {0.8, 0.9, 0.95, 1.0, 1.05, 1.1, 1.2};
+    static constexpr size_t num_moneyness_buckets = std::size(moneyness_edges) + 1;
+
+    // load positions from a csv with the header ticker,expiration,strike,optionType,quantity;
+    // positions in contracts that are not loaded are skipped, returns the number of positions added
+    size_t load_positions(const std::string &filename,
+                          const std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers);
+    // the rows of a positions csv, empty if the file cannot be opened
+    static std::vector<PositionRow> read_positions(const std::string &filename);
+    // add the rows held in this ticker's contracts, returns the number added
+    size_t add_positions(const std::vector<PositionRow> &rows, const Ticker &ticker);
+
+    // add one position, returns false if the ticker or contract is not loaded
+    bool add_position(const Ticker &ticker, const OptionData &option, double quantity);
+
+    // recompute every bucket from the current greeks of all positions
+    void aggregate();
+    // take the current greeks of a ticker's positions as final and stop reading its chain, so the ticker
+    // can be released; later aggregations keep these contributions and updates skip its contracts
+    void release_ticker(const std::string &ticker);
+
+    // re-read the greeks of the positions in these contracts (contract_hash keys)
+    // and move the bucket totals by their change only
+    void update_contracts(const std::vector<uint64_t> &contractKeys);
+    // change the quantity held in a contract, returns false if there is no position in it
+    bool set_quantity(uint64_t contractKey, double quantity);
+
+    size_t size() const { return quantity_.size(); }
+    // tickers in the order their first position was added
+    const std::vector<std::string> &ticker_names() const { return tickerNames_; }
+    const RiskTotals &ticker_totals(const std::string &ticker) const;
+
+    // one row per non-empty bucket of every aggregation level
+    void write_report(const std::string &filename) const;
+
+private:
+    // contribution of position i from its contract's current greeks
+    void contribution_(size_t i, double &delta, double &gamma, double &vega) const;
+    void apply_(size_t i, double sign);
+    size_t expiry_bucket_(size_t tickerId, const std::string &expiration);
+    // add the rows found in the contract index, counting the rest as skipped
+    size_t add_rows_(const std::vector<PositionRow> &rows,
+                     const std::unordered_map<uint64_t, std::pair<const Ticker *, const OptionData *>> &contracts,
+                     size_t &skipped);
+
+    // bucket directories
+    std::vector<std::string> tickerNames_;
+    std::unordered_map<std::string, size_t> tickerIds_;
+    std::vector<std::pair<size_t, std::string>> expiryBuckets_; // (ticker id, expiration)
+    std::unordered_map<std::string, size_t> expiryIds_;
+
+    // position columns
+    std::vector<const OptionData *> contract_; // null once the position's ticker is released
+    std::vector<uint64_t> contractKey_;
+    std::vector<double> quantity_;
+    std::vector<double> spot_; // underlying the greeks are quoted against
+    std::vector<uint32_t> tickerId_, expiryId_, moneynessId_;
+    // last aggregated contribution of every position, so updates only apply differences
+    std::vector<double> dollarDelta_, dollarGamma_, dollarVega_;
+    std::unordered_multimap<uint64_t, size_t> positionsByContract_;
+
+    // bucket totals
+    std::vector<RiskTotals> byTicker_, byExpiry_, byMoneyness_;
+};
@@ -0,0 +1,364 @@
+#include "QuoteFeed.h"
+#include "SpmcRing.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    uint64_t now_nanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // parse a csv field as a double, empty fields are zero like in read_csv_into_ticker_object
+    bool parse_double(std::string_view field, double &value)
+    {
+        if (field.empty())
+        {
+            value = 0.0;
+            return true;
+        }
+        auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        return result.ec == std::errc();
+    }
+
+    // copy a csv field into a fixed size, null terminated buffer
+    template <size_t N>
+    bool copy_field(std::string_view field, char (&buffer)[N])
+    {
+        if (field.empty() || field.size() >= N)
+        {
+            return false;
+        }
+        std::memcpy(buffer, field.data(), field.size());
+        buffer[field.size()] = '\0';
+        return true;
+    }
+
+    // open the replay source, a regular file or a connected unix domain socket
+    int open_source(const std::string &source)
+    {
+        const std::string prefix = "unix:";
+        if (source.compare(0, prefix.size(), prefix) != 0)
+        {
+            return ::open(source.c_str(), O_RDONLY);
+        }
+
+        std::string path = source.substr(prefix.size());
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // a loaded contract and the ticker that owns it
+    struct ContractRef
+    {
+        Ticker *ticker;
+        const std::string *tickerName; // key of the ticker in the loaded map
+        OptionData *option;
+        uint64_t lastSequence = 0; // sequence of the last quote applied, guarded by the contract's stripe
+    };
+
+    // whether a quote is for this contract; contracts whose hashes collide share an index key
+    bool quote_matches(const ContractRef &contract, const QuoteMessage &msg)
+    {
+        const OptionData &option = *contract.option;
+        return option.strike == msg.strike && option.expiration == msg.expiration &&
+               option.optionType == msg.optionType && *contract.tickerName == msg.ticker;
+    }
+}
+
+bool decode_quote(const std::string &line, QuoteMessage &msg)
+{
+    // index,ticker,expiration,timeToMaturity,strike,optionType,lastPrice,bid,ask,
+    // volume,openInterest,impliedVolatility,inTheMoney,spotPrice,interestRate
+    constexpr size_t num_fields = 15;
+    std::string_view fields[num_fields];
+
+    std::string_view rest(line);
+    if (!rest.empty() && rest.back() == '\r')
+    {
+        rest.remove_suffix(1);
+    }
+
+    size_t count = 0;
+    while (count < num_fields)
+    {
+        size_t comma = rest.find(',');
+        fields[count++] = rest.substr(0, comma);
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        rest.remove_prefix(comma + 1);
+    }
+    if (count != num_fields)
+    {
+        return false;
+    }
+
+    return copy_field(fields[1], msg.ticker) &&
+           copy_field(fields[2], msg.expiration) &&
+           copy_field(fields[5], msg.optionType) &&
+           parse_double(fields[3], msg.timeToMaturity) &&
+           parse_double(fields[4], msg.strike) &&
+           parse_double(fields[6], msg.lastPrice) &&
+           parse_double(fields[7], msg.bid) &&
+           parse_double(fields[8], msg.ask) &&
+           parse_double(fields[13], msg.spotPrice) &&
+           msg.spotPrice > 0;
+}
+
+void LatencyHistogram::record(uint64_t nanos)
+{
+    int bucket = std::min(static_cast<int>(std::bit_width(nanos)), num_buckets - 1);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (nanos > prev && !max_.compare_exchange_weak(prev, nanos, std::memory_order_relaxed))
+    {
+    }
+}
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum_.load()) / n;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    uint64_t n = count();
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(p * n));
+    uint64_t seen = 0;
+    for (int i = 0; i < num_buckets; ++i)
+    {
+        seen += buckets_[i].load();
+        if (seen >= rank && seen > 0)
+        {
+            return std::min(uint64_t{1} << i, max());
+        }
+    }
+    return max();
+}
+
+// print percentiles and one row per non-empty bucket
+std::ostream &operator<<(std::ostream &os, const LatencyHistogram &hist)
+{
+    os << "tick-to-IV latency (us): n=" << hist.count()
+       << " mean=" << hist.mean() / 1e3
+       << " p50<=" << hist.percentile(0.50) / 1e3
+       << " p90<=" << hist.percentile(0.90) / 1e3
+       << " p99<=" << hist.percentile(0.99) / 1e3
+       << " max=" << hist.max() / 1e3 << "\n";
+
+    uint64_t n = std::max<uint64_t>(hist.count(), 1);
+    for (int i = 0; i < LatencyHistogram::num_buckets; ++i)
+    {
+        uint64_t bucketCount = hist.buckets_[i].load();
+        if (bucketCount == 0)
+        {
+            continue;
+        }
+        double lo = i == 0 ? 0.0 : (uint64_t{1} << (i - 1)) / 1e3;
+        double hi = (uint64_t{1} << i) / 1e3;
+        os << std::setw(12) << lo << " - " << std::setw(12) << hi << " us "
+           << std::setw(10) << bucketCount << " "
+           << std::string(static_cast<size_t>(50.0 * bucketCount / n), '#') << "\n";
+    }
+    return os;
+}
+
+ReplayStats replay_quotes(const std::string &source,
+                          std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers,
+                          unsigned consumers, LatencyHistogram &latency, size_t ringCapacity)
+{
+    ReplayStats stats;
+
+    int fd = open_source(source);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Unable to open replay source " << source << std::endl;
+        return stats;
+    }
+
+    // index every loaded contract by its hash so consumers never search the chains
+    std::unordered_multimap<uint64_t, ContractRef> index;
+    for (auto &[name, ticker] : tickers)
+    {
+        for (const auto &option : ticker->getOptions())
+        {
+            index.emplace(contract_hash(name, option->expiration, option->strike, option->optionType),
+                          ContractRef{ticker.get(), &name, option.get()});
+        }
+    }
+
+    // striped locks so two consumers never update the same contract at once
+    constexpr size_t num_stripes = 256;
+    std::vector<std::mutex> stripes(num_stripes);
+
+    SpmcRing<QuoteMessage> ring(ringCapacity);
+    std::atomic<bool> readerDone{false};
+    std::atomic<uint64_t> unmatched{0};
+    std::atomic<uint64_t> stale{0};
+    std::atomic<uint64_t> processed{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    // reader thread: pull lines off the feed, decode them and publish them to the ring
+    std::thread reader([&]
+                       {
+        std::vector<char> buffer(1 << 16);
+        std::string pending;
+        QuoteMessage msg;
+        uint64_t sequence = 0;
+
+        auto handle_line = [&](const std::string &line)
+        {
+            uint64_t received = now_nanos();
+            stats.linesRead++;
+            if (!decode_quote(line, msg))
+            {
+                return;
+            }
+            msg.receivedNanos = received;
+            msg.sequence = ++sequence;
+            stats.decoded++;
+            if (!ring.try_push(msg))
+            {
+                stats.dropped++; // never block the feed on slow consumers
+            }
+        };
+
+        while (true)
+        {
+            ssize_t n = ::read(fd, buffer.data(), buffer.size());
+            if (n <= 0)
+            {
+                break;
+            }
+            pending.append(buffer.data(), static_cast<size_t>(n));
+
+            size_t begin = 0, newline;
+            while ((newline = pending.find('\n', begin)) != std::string::npos)
+            {
+                handle_line(pending.substr(begin, newline - begin));
+                begin = newline + 1;
+            }
+            pending.erase(0, begin);
+        }
+        if (!pending.empty())
+        {
+            handle_line(pending);
+        }
+
+        ::close(fd);
+        readerDone.store(true, std::memory_order_release); });
+
+    // consumer threads: apply the quote to its contract and recompute IVs and greeks
+    auto consume = [&]
+    {
+        QuoteMessage msg;
+        while (true)
+        {
+            if (!ring.try_pop(msg))
+            {
+                // drain whatever was published before the reader finished, then stop
+                if (readerDone.load(std::memory_order_acquire))
+                {
+                    if (!ring.try_pop(msg))
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+            }
+
+            uint64_t hash = contract_hash(msg.ticker, msg.expiration, msg.strike, msg.optionType);
+            auto [first, last] = index.equal_range(hash);
+            auto it = std::find_if(first, last, [&msg](const auto &entry)
+                                   { return quote_matches(entry.second, msg); });
+            if (it == last)
+            {
+                unmatched.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(stripes[hash % num_stripes]);
+                // another consumer may have popped a later quote for this contract and applied it first
+                if (msg.sequence <= it->second.lastSequence)
+                {
+                    stale.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                it->second.lastSequence = msg.sequence;
+                OptionData &option = *it->second.option;
+                option.timeToMaturity = msg.timeToMaturity;
+                option.lastPrice = msg.lastPrice;
+                option.bid = msg.bid;
+                option.ask = msg.ask;
+                it->second.ticker->calculate_iv_and_greeks(option, msg.spotPrice);
+            }
+
+            latency.record(now_nanos() - msg.receivedNanos);
+            processed.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::max(consumers, 1u); ++i)
+    {
+        workers.emplace_back(consume);
+    }
+
+    reader.join();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.unmatched = unmatched.load();
+    stats.stale = stale.load();
+    stats.processed = processed.load();
+    return stats;
+}
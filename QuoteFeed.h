@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Ticker.h"
+
+// one decoded quote update, fixed size and trivially copyable so it can live in the ring buffer
+struct QuoteMessage
+{
+    char ticker[16];
+    char expiration[16];
+    char optionType[8];
+    double timeToMaturity;
+    double strike;
+    double lastPrice;
+    double bid;
+    double ask;
+    double spotPrice;
+    uint64_t receivedNanos; // steady clock time the reader pulled the line off the feed
+    uint64_t sequence;      // feed order, assigned by the reader from 1
+};
+
+// decode one line in the options_data csv layout, returns false for headers and malformed lines
+bool decode_quote(const std::string &line, QuoteMessage &msg);
+
+// log2 bucketed latency histogram that many threads can record into
+class LatencyHistogram
+{
+public:
+    void record(uint64_t nanos);
+
+    uint64_t count() const { return count_.load(); }
+    uint64_t max() const { return max_.load(); }
+    double mean() const;
+    // upper edge of the bucket holding the p-th percentile (p in [0, 1])
+    uint64_t percentile(double p) const;
+
+    friend std::ostream &operator<<(std::ostream &os, const LatencyHistogram &hist);
+
+private:
+    static constexpr int num_buckets = 48; // bucket i counts latencies in [2^(i-1), 2^i) ns
+    std::array<std::atomic<uint64_t>, num_buckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// counters of one replay run
+struct ReplayStats
+{
+    uint64_t linesRead = 0;
+    uint64_t decoded = 0;
+    uint64_t dropped = 0;   // ring buffer was full
+    uint64_t unmatched = 0; // no loaded contract for the quote
+    uint64_t stale = 0;     // a later quote for the same contract was already applied
+    uint64_t processed = 0;
+    double seconds = 0;
+};
+
+// replay quotes from a file, or from a unix domain socket when the source is "unix:<path>",
+// on a dedicated reader thread while consumer threads update the tickers and recompute IVs and greeks
+ReplayStats replay_quotes(const std::string &source,
+                          std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers,
+                          unsigned consumers, LatencyHistogram &latency,
+                          size_t ringCapacity = 1 << 16);
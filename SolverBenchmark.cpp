@@ -0,0 +1,219 @@
+#include "SolverBenchmark.h"
+#include "BlackScholes.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sched.h>
+
+namespace
+{
+    // one contract as the solvers see it
+    struct BenchmarkCase
+    {
+        BlackScholes bs;
+        double price;
+        double reference;
+    };
+
+    long double reference_price(long double K, long double S, long double T, long double r, long double q, int phi, long double vol)
+    {
+        long double sqrtT = std::sqrt(T);
+        long double d1 = (std::log(S / K) + (r - q + 0.5L * vol * vol) * T) / (vol * sqrtT);
+        long double d2 = d1 - vol * sqrtT;
+        long double nD1 = 0.5L * std::erfc(-phi * d1 / std::sqrt(2.0L));
+        long double nD2 = 0.5L * std::erfc(-phi * d2 / std::sqrt(2.0L));
+        return phi * (S * std::exp(-q * T) * nD1 - K * std::exp(-r * T) * nD2);
+    }
+
+    // pin the calling thread to one cpu, restored when this goes out of scope
+    class CorePin
+    {
+    public:
+        explicit CorePin(int core)
+        {
+            if (core < 0 || sched_getaffinity(0, sizeof(previous_), &previous_) != 0)
+                return;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(core, &set);
+            pinned_ = sched_setaffinity(0, sizeof(set), &set) == 0;
+        }
+        ~CorePin()
+        {
+            if (pinned_)
+                sched_setaffinity(0, sizeof(previous_), &previous_);
+        }
+        bool pinned() const { return pinned_; }
+
+    private:
+        cpu_set_t previous_;
+        bool pinned_ = false;
+    };
+
+    using Solver = std::function<double(BlackScholes &, double, int *)>;
+}
+
+double reference_implied_vol(double strike, double spot, double T, double rate, double dividend, int phi, double price)
+{
+    long double lo = 1e-4L, hi = 3.0L;
+    long double target = price;
+    auto f = [&](long double vol)
+    { return reference_price(strike, spot, T, rate, dividend, phi, vol) - target; };
+
+    long double flo = f(lo);
+    if (flo * f(hi) > 0)
+    {
+        return -1;
+    }
+
+    // the price is increasing in vol, so bisect on the sign until the bracket is below double resolution
+    for (int i = 0; i < 200 && hi - lo > 1e-15L; ++i)
+    {
+        long double mid = (lo + hi) / 2;
+        long double fmid = f(mid);
+        if ((fmid < 0) == (flo < 0))
+        {
+            lo = mid;
+            flo = fmid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return static_cast<double>((lo + hi) / 2);
+}
+
+std::vector<SolverStats> benchmark_solvers(const std::vector<const Ticker *> &tickers, const SolverBenchmarkConfig &config)
+{
+    std::vector<BenchmarkCase> cases;
+    size_t skipped = 0;
+    for (const Ticker *ticker : tickers)
+    {
+        double spot = ticker->getSpotPrice();
+        for (const auto &option : ticker->getOptions())
+        {
+            double price = option->market_price();
+            if (!(price > 0))
+            {
+                continue; // no market data, never solved
+            }
+
+            // the reference IV is European, so the solvers are timed on the European model
+            BlackScholes model = ticker->pricing_model(*option, spot).european();
+            double reference = reference_implied_vol(model.get_strike(), model.get_spot(), model.get_time_to_maturity(),
+                                                     model.get_interest_rate(), model.get_dividend_yield(),
+                                                     static_cast<int>(model.get_payoff_type()), price);
+            if (reference < 0)
+            {
+                skipped++;
+                continue;
+            }
+            cases.push_back({model, price, reference});
+        }
+    }
+
+    // the same entry points and default guesses OptionData::calculate_iv_and_greeks uses
+    const std::pair<const char *, Solver> solvers[] = {
+        {"Bisection", [](BlackScholes &bs, double price, int *iterations)
+         { return bisection_method(bs, price, false, 0, iterations); }},
+        {"Newton", [](BlackScholes &bs, double price, int *iterations)
+         { return newton_method(bs, price, 2, iterations); }},
+        {"Secant", [](BlackScholes &bs, double price, int *iterations)
+         { return secant_method(bs, price, 2, iterations); }},
+    };
+
+    CorePin pin(config.core);
+    std::vector<SolverStats> report;
+    std::vector<double> results(cases.size());
+    std::vector<int> iterations(cases.size());
+
+    for (const auto &[name, solve] : solvers)
+    {
+        SolverStats stats;
+        stats.solver = name;
+        stats.contracts = cases.size();
+        stats.skipped = skipped;
+        stats.repetitions = std::max(1, config.repetitions);
+        stats.pinned = pin.pinned();
+
+        // accuracy and iteration counts from one pass, they are the same on every pass
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            results[i] = solve(cases[i].bs, cases[i].price, &iterations[i]);
+        }
+        double errorSum = 0;
+        long iterationSum = 0;
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            iterationSum += iterations[i];
+            stats.maxIterations = std::max(stats.maxIterations, iterations[i]);
+            double error = std::abs(results[i] - cases[i].reference);
+            if (!std::isfinite(results[i]) || error > config.tolerance)
+            {
+                stats.failures++;
+                continue;
+            }
+            errorSum += error;
+            stats.maxAbsError = std::max(stats.maxAbsError, error);
+        }
+        if (!cases.empty())
+        {
+            stats.meanIterations = static_cast<double>(iterationSum) / cases.size();
+            stats.failureRate = static_cast<double>(stats.failures) / cases.size();
+        }
+        if (stats.failures < cases.size())
+        {
+            stats.meanAbsError = errorSum / (cases.size() - stats.failures);
+        }
+
+        for (int w = 0; w < config.warmups; ++w)
+        {
+            for (size_t i = 0; i < cases.size(); ++i)
+            {
+                results[i] = solve(cases[i].bs, cases[i].price, nullptr);
+            }
+        }
+
+        std::vector<double> seconds(stats.repetitions);
+        for (double &elapsed : seconds)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < cases.size(); ++i)
+            {
+                results[i] = solve(cases[i].bs, cases[i].price, nullptr);
+            }
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::sort(seconds.begin(), seconds.end());
+        stats.minSeconds = seconds.front();
+        stats.medianSeconds = seconds[seconds.size() / 2];
+        stats.solvesPerSecond = stats.medianSeconds > 0 ? cases.size() / stats.medianSeconds : 0;
+
+        report.push_back(stats);
+    }
+    return report;
+}
+
+void write_solver_report(const std::string &filename, const std::vector<SolverStats> &stats)
+{
+    std::ofstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Unable to open file " << filename << std::endl;
+        return;
+    }
+
+    file << "Solver,Contracts,Skipped,Repetitions,MedianSeconds,MinSeconds,SolvesPerSecond,"
+         << "MeanIterations,MaxIterations,Failures,FailureRate,MeanAbsError,MaxAbsError,Pinned\n";
+    for (const SolverStats &s : stats)
+    {
+        file << s.solver << "," << s.contracts << "," << s.skipped << "," << s.repetitions << ","
+             << s.medianSeconds << "," << s.minSeconds << "," << s.solvesPerSecond << ","
+             << s.meanIterations << "," << s.maxIterations << "," << s.failures << "," << s.failureRate << ","
+             << s.meanAbsError << "," << s.maxAbsError << "," << (s.pinned ? "True" : "False") << "\n";
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Ticker.h"
+
+struct SolverBenchmarkConfig
+{
+    int repetitions = 20; // timed passes over the whole chain per solver
+    int warmups = 3;      // untimed passes first, to fault in code and data
+    int core = 0;         // cpu the benchmark thread is pinned to, -1 leaves the affinity alone
+    double tolerance = 1e-4; // |IV - reference IV| above this counts as a failure
+};
+
+// throughput and accuracy of one root finder over a chain
+struct SolverStats
+{
+    std::string solver;
+    size_t contracts = 0; // contracts with a reference root, the others are skipped
+    size_t skipped = 0;   // market price outside the Black-Scholes range for vols in [1e-4, 3]
+    int repetitions = 0;
+    double medianSeconds = 0; // of one pass over all contracts
+    double minSeconds = 0;
+    double solvesPerSecond = 0; // contracts / medianSeconds
+    double meanIterations = 0;
+    int maxIterations = 0;
+    size_t failures = 0; // non-finite result or further than the tolerance from the reference
+    double failureRate = 0;
+    double meanAbsError = 0; // against the reference IV, over the contracts that did not fail
+    double maxAbsError = 0;
+    bool pinned = false;
+};
+
+// implied vol solved to 1e-15 in long double, the reference the solvers are scored against;
+// returns -1 when the price is outside the range of vols in [1e-4, 3]
+double reference_implied_vol(double strike, double spot, double T, double rate, double dividend, int phi, double price);
+
+// run bisection, Newton and secant over every contract of the tickers, each on the same inputs
+// Ticker::calculate_iv_and_greeks uses, single threaded on a pinned core after warm-up passes;
+// the iteration counts, errors and failures are deterministic, only the timings vary between runs
+std::vector<SolverStats> benchmark_solvers(const std::vector<const Ticker *> &tickers, const SolverBenchmarkConfig &config = {});
+
+void write_solver_report(const std::string &filename, const std::vector<SolverStats> &stats);
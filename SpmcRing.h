@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+// bounded lock-free ring buffer with a single producer and any number of consumers
+// every slot carries a sequence number (Vyukov's bounded queue), so the producer never
+// waits on a consumer: a full ring makes try_push fail instead of blocking
+template <typename T>
+class SpmcRing
+{
+public:
+    explicit SpmcRing(size_t capacity)
+        : mask_(capacity - 1), slots_(std::make_unique<Slot[]>(capacity))
+    {
+        if (capacity < 2 || (capacity & mask_) != 0)
+        {
+            throw std::invalid_argument("SpmcRing capacity must be a power of two");
+        }
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // producer side, returns false if the ring is full
+    bool try_push(const T &value)
+    {
+        Slot &slot = slots_[tail_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != tail_)
+        {
+            return false; // slot still holds an unread value
+        }
+        slot.value = value;
+        slot.sequence.store(tail_ + 1, std::memory_order_release);
+        tail_++;
+        return true;
+    }
+
+    // consumer side, returns false if the ring is empty
+    bool try_pop(T &value)
+    {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot &slot = slots_[pos & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+
+            if (diff == 0)
+            {
+                // the slot is published, claim it before another consumer does
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    value = slot.value;
+                    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // nothing published at this position yet
+            }
+            else
+            {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> head_{0}; // next position to read, shared by the consumers
+    alignas(64) size_t tail_ = 0;             // next position to write, owned by the producer
+};
@@ -1,11 +1,18 @@
 #include "Ticker.h"
 #include "util.h"
+#include "Parallel.h"
+#include "BlackScholes.h"
+#include "BatchIV.h"
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 // Constructor
 Ticker::Ticker(const std::string &name, double spot, double rate)
-    : tickerName(name), spotPrice(spot), interestRate(rate) {}
+    : tickerName(name), spotPrice(spot), interestRate(rate),
+      underlyingType(name.starts_with('^') ? UnderlyingType::Index : UnderlyingType::Equity) {}
 
 // add new option data to the existing Ticker object
 void Ticker::addOptionData(std::unique_ptr<OptionData> option)
@@ -13,9 +20,93 @@ void Ticker::addOptionData(std::unique_ptr<OptionData> option)
     options.push_back(std::move(option));
 }
 
+void Ticker::build_slices()
+{
+    // bucket the contracts by expiration, keyed by the ISO date so the buckets are in time order
+    std::map<std::string, std::vector<std::unique_ptr<OptionData>>> buckets;
+    for (auto &option : options)
+    {
+        buckets[option->expiration].push_back(std::move(option));
+    }
+    std::vector<std::vector<std::unique_ptr<OptionData>> *> expiries;
+    for (auto &[expiration, bucket] : buckets)
+    {
+        expiries.push_back(&bucket);
+    }
+
+    // sort every expiration by type and strike, calls first, duplicates keep their input order
+    parallel_for(expiries.size(), [&expiries](size_t begin, size_t end)
+                 {
+        for (size_t e = begin; e < end; ++e)
+        {
+            std::stable_sort(expiries[e]->begin(), expiries[e]->end(),
+                             [](const std::unique_ptr<OptionData> &a, const std::unique_ptr<OptionData> &b)
+                             {
+                                 bool aPut = a->optionType != "Call", bPut = b->optionType != "Call";
+                                 if (aPut != bPut)
+                                     return bPut;
+                                 return a->strike < b->strike;
+                             });
+        } });
+
+    // concatenate the slices back into the chain and record their ranges
+    options.clear();
+    slices.clear();
+    strikes.clear();
+    for (auto *bucket : expiries)
+    {
+        ExpirySlice slice{bucket->front()->expiration, bucket->front()->timeToMaturity, options.size(), options.size(), options.size()};
+        for (auto &option : *bucket)
+        {
+            if (option->optionType == "Call")
+            {
+                slice.putBegin++;
+            }
+            strikes.push_back(option->strike);
+            options.push_back(std::move(option));
+        }
+        slice.end = options.size();
+        slices.push_back(std::move(slice));
+    }
+    slicedContracts = options.size();
+}
+
+const ExpirySlice *Ticker::findSlice(const std::string &expiration) const
+{
+    if (!slices_current())
+    {
+        return nullptr;
+    }
+    auto it = std::lower_bound(slices.begin(), slices.end(), expiration,
+                               [](const ExpirySlice &slice, const std::string &exp)
+                               { return slice.expiration < exp; });
+    return (it != slices.end() && it->expiration == expiration) ? &(*it) : nullptr;
+}
+
+size_t Ticker::find_strike(size_t begin, size_t end, double strike) const
+{
+    auto it = std::lower_bound(strikes.begin() + begin, strikes.begin() + end, strike);
+    return (it != strikes.begin() + end && *it == strike) ? static_cast<size_t>(it - strikes.begin()) : end;
+}
+
 // find an option based on strike, expiration, and type
 OptionData *Ticker::findOption(double strike, const std::string &expiration, const std::string &optionType) const
 {
+    // binary search the slice directory and then the strikes of the call or put side
+    if (slices_current())
+    {
+        const ExpirySlice *slice = findSlice(expiration);
+        if (!slice)
+        {
+            return nullptr;
+        }
+        bool isCall = optionType == "Call";
+        size_t begin = isCall ? slice->callBegin : slice->putBegin;
+        size_t end = isCall ? slice->putBegin : slice->end;
+        size_t i = find_strike(begin, end, strike);
+        return (i != end && options[i]->optionType == optionType) ? options[i].get() : nullptr;
+    }
+
     for (const auto &option : options)
     {
         if (option->strike == strike && option->expiration == expiration && option->optionType == optionType)
@@ -26,86 +117,289 @@ OptionData *Ticker::findOption(double strike, const std::string &expiration, con
     return nullptr; // return nullptr if no matching option is found
 }
 
-void Ticker::calculate_implied_vols_and_greeks()
+// find the parity fit of an expiration using binary search over the sorted fits
+const ParityFit *Ticker::findParityFit(const std::string &expiration) const
 {
-    for (auto &option : options)
+    auto it = std::lower_bound(parityFits.begin(), parityFits.end(), expiration,
+                               [](const ParityFit &fit, const std::string &exp)
+                               { return fit.expiration < exp; });
+    if (it != parityFits.end() && it->expiration == expiration)
+    {
+        return &(*it);
+    }
+    return nullptr;
+}
+
+void Ticker::solve_slices(const SliceSolver &batch, std::vector<double> &seeds) const
+{
+    std::vector<double> sliceStrikes, phis, prices, vols;
+    for (const ExpirySlice &slice : slices)
+    {
+        size_t n = slice.end - slice.callBegin;
+        sliceStrikes.assign(strikes.begin() + slice.callBegin, strikes.begin() + slice.end);
+        phis.resize(n);
+        prices.resize(n);
+        vols.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            phis[i] = slice.callBegin + i < slice.putBegin ? 1.0 : -1.0;
+            prices[i] = options[slice.callBegin + i]->market_price();
+        }
+
+        batch(pricing_model(*options[slice.callBegin], spotPrice), n, sliceStrikes.data(), phis.data(), prices.data(), vols.data());
+        std::copy(vols.begin(), vols.end(), seeds.begin() + slice.callBegin);
+    }
+}
+
+void Ticker::calculate_implied_vols_and_greeks(IVCache *cache)
+{
+    std::vector<double> seeds(options.size(), 0.0);
+    EarlyExercise earlyExercise = iv_settings().american;
+    if (underlyingType == UnderlyingType::Index && slices_current())
+    {
+        // index chains: solve every expiration in one batch under Black-76 and warm-start the three solvers from it
+        solve_slices([](const BlackScholes &model, size_t n, const double *strikes, const double *phis, const double *prices, double *vols)
+                     {
+                         double T = model.get_time_to_maturity();
+                         double discount = std::exp(-model.get_interest_rate() * T);
+                         implied_vol_batch(model.get_spot(), discount, T, n, strikes, phis, prices, vols); },
+                     seeds);
+    }
+    else if (underlyingType == UnderlyingType::Equity && earlyExercise != EarlyExercise::None && slices_current())
+    {
+        // American equity chains: the same per-expiry batch under the early exercise approximation, whose
+        // critical prices are solved for all strikes of the expiration at once
+        solve_slices([earlyExercise](const BlackScholes &model, size_t n, const double *strikes, const double *phis,
+                                     const double *prices, double *vols)
+                     { american_implied_vol_batch(earlyExercise, model.get_spot(), model.get_interest_rate(), model.get_dividend_yield(),
+                                                  model.get_time_to_maturity(), n, strikes, phis, prices, vols); },
+                     seeds);
+    }
+
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        calculate_iv_and_greeks(*options[i], spotPrice, cache, seeds[i]); // each option calculates its IV
+    }
+}
+
+void Ticker::solver_inputs(const OptionData &option, double &rate, double &dividend) const
+{
+    // use the implied rate and dividend of the parity fit if put-call parity was calculated first
+    const ParityFit *fit = findParityFit(option.expiration);
+    rate = fit ? fit->impliedRate : interestRate;
+    dividend = fit ? fit->impliedDividend : 0.0;
+}
+
+BlackScholes Ticker::pricing_model(const OptionData &option, double spot) const
+{
+    double rate, dividend;
+    solver_inputs(option, rate, dividend);
+    PayoffType payoffType = option.optionType == "Call" ? PayoffType::Call : PayoffType::Put;
+
+    if (underlyingType == UnderlyingType::Equity)
+    {
+        return BlackScholes(option.strike, spot, option.timeToMaturity, rate, payoffType, dividend)
+            .with_early_exercise(iv_settings().american);
+    }
+
+    // Black-76 off the parity-implied forward, moved with the spot when repricing at another level
+    const ParityFit *fit = findParityFit(option.expiration);
+    double forward = fit ? fit->forward * spot / spotPrice
+                         : spot * std::exp((rate - dividend) * option.timeToMaturity);
+    return BlackScholes::black76(option.strike, forward, option.timeToMaturity, rate, payoffType);
+}
+
+void Ticker::calculate_iv_and_greeks(OptionData &option, double spot, IVCache *cache, double initialVol) const
+{
+    BlackScholes model = pricing_model(option, spot);
+
+    if (!cache)
+    {
+        option.calculate_iv_and_greeks(model, initialVol);
+        return;
+    }
+
+    uint64_t key = contract_hash(tickerName, option.expiration, option.strike, option.optionType);
+    // a cached solution only matches a run with the same solvers and greek methods
+    uint64_t quoteHash = option.quote_hash(model.get_spot(), model.get_interest_rate(), model.get_dividend_yield()) ^
+                         iv_settings().disabled_mask();
+    const IVCache::Entry *cached = cache->find(key);
+
+    if (cached && cached->quoteHash == quoteHash)
+    {
+        // unchanged quote, reuse the stored solution
+        option.bisectionImpliedVol = cached->bisectionImpliedVol;
+        option.newtonImpliedVol = cached->newtonImpliedVol;
+        option.secantImpliedVol = cached->secantImpliedVol;
+        option.bisectionTime = option.newtonTime = option.secantTime = 0;
+        option.delta_bs = cached->delta_bs;
+        option.gamma_bs = cached->gamma_bs;
+        option.vega_bs = cached->vega_bs;
+        option.delta_fd = cached->delta_fd;
+        option.gamma_fd = cached->gamma_fd;
+        option.vega_fd = cached->vega_fd;
+        cache->stats.hits++;
+        return;
+    }
+
+    // warm-start from the bisection IV, the most robust of the three cached solutions
+    double cachedVol = cached ? (cached->bisectionImpliedVol > 0 ? cached->bisectionImpliedVol : cached->newtonImpliedVol) : 0;
+    if (cachedVol > 0)
+    {
+        option.calculate_iv_and_greeks(model, cachedVol);
+        cache->stats.warmStarts++;
+    }
+    else
     {
-        option->calculate_iv_and_greeks(spotPrice, interestRate); // each option calculates its IV
+        option.calculate_iv_and_greeks(model, initialVol);
+        cache->stats.misses++;
     }
+
+    cache->store({key, quoteHash,
+                  option.bisectionImpliedVol, option.newtonImpliedVol, option.secantImpliedVol,
+                  option.delta_bs, option.gamma_bs, option.vega_bs,
+                  option.delta_fd, option.gamma_fd, option.vega_fd});
 }
 
 void Ticker::calculate_put_call_parity()
 {
-    for (const auto &option : options)
+    if (!slices_current())
+    {
+        build_slices();
+    }
+
+    parityFits.clear();
+    parityPairs.clear();
+    std::vector<double> pairStrikes, spreads;
+
+    for (const ExpirySlice &slice : slices)
     {
-        // find corresponding Call if current option is a Put
-        if (option->optionType == "Put")
+        // pair up calls and puts of the same strike by merging the two strike-sorted sides
+        pairStrikes.clear();
+        spreads.clear();
+        size_t firstPair = parityPairs.size();
+        size_t c = slice.callBegin, p = slice.putBegin;
+        while (c < slice.putBegin && p < slice.end)
         {
-            OptionData *callOption = findOption(option->strike, option->expiration, "Call");
-            if (callOption)
+            if (strikes[c] < strikes[p])
             {
-                // calculate the put price by using C - S0 + K * e^-rT
-                double discount_factor = exp(-interestRate * option->timeToMaturity);
-                option->parity_price = callOption->lastPrice - spotPrice + (option->strike * discount_factor);
+                c++;
+                continue;
             }
-        }
-        // find corresponding Put if current option is a Call
-        else if (option->optionType == "Call")
-        {
-            OptionData *putOption = findOption(option->strike, option->expiration, "Put");
-            if (putOption)
+            if (strikes[p] < strikes[c])
             {
-                // calculate the call price by using P + S0 - K * e^-rT
-                double discount_factor = exp(-interestRate * option->timeToMaturity);
-                option->parity_price = putOption->lastPrice + spotPrice - (option->strike * discount_factor);
+                p++;
+                continue;
             }
+
+            OptionData *call = options[c++].get();
+            OptionData *put = options[p++].get();
+            parityPairs.emplace_back(call, put);
+
+            // only pairs with two sided quotes on both legs enter the regression
+            if (call->bid > 0 && call->ask > 0 && put->bid > 0 && put->ask > 0)
+            {
+                pairStrikes.push_back(call->strike);
+                spreads.push_back(call->market_price() - put->market_price());
+            }
+        }
+
+        // regress C - P = D * (F - K) for the implied forward and discount factor of this expiration
+        ParityFit fit = fit_parity(pairStrikes, spreads, spotPrice, slice.timeToMaturity, interestRate);
+        fit.expiration = slice.expiration;
+
+        // price each leg from the other one and record the parity residual
+        for (size_t i = firstPair; i < parityPairs.size(); ++i)
+        {
+            auto [call, put] = parityPairs[i];
+            double forwardValue = fit.discountFactor * (fit.forward - call->strike);
+
+            // P = C - D * (F - K) and C = P + D * (F - K)
+            put->parity_price = call->market_price() - forwardValue;
+            call->parity_price = put->market_price() + forwardValue;
+
+            double residual = call->market_price() - put->market_price() - forwardValue;
+            call->parity_residual = residual;
+            put->parity_residual = residual;
         }
+
+        parityFits.push_back(std::move(fit));
     }
 }
 
 // Implementation of calculating the Black Scholes price using the other Ticker's calculated Implied Volatility
 void Ticker::calculate_bs_price_from_other_ticker(const std::unique_ptr<Ticker> &tickerData1)
 {
-    size_t i = 0, j = 0;
-
-    while (i < options.size() && j < tickerData1->options.size())
+    if (!slices_current())
+    {
+        build_slices();
+    }
+    if (!tickerData1->slices_current())
     {
-        OptionData *myOption = options[i].get();
-        OptionData *otherOption = tickerData1->options[j].get();
+        tickerData1->build_slices();
+    }
 
-        // If options match by strike, expiration, and type
-        if (myOption->strike == otherOption->strike &&
-            myOption->expiration == otherOption->expiration &&
-            myOption->optionType == otherOption->optionType)
+    // merge-join two strike-sorted ranges and price the matches with the other ticker's IV
+    auto price_matches = [&](size_t i, size_t end, size_t j, size_t otherEnd)
+    {
+        while (i < end && j < otherEnd)
         {
-            // Use Black-Scholes model with other ticker's IV
-            if (otherOption->bisectionImpliedVol > 0)
+            if (strikes[i] < tickerData1->strikes[j])
+            {
+                i++;
+            }
+            else if (tickerData1->strikes[j] < strikes[i])
             {
-                myOption->calculate_bs_price(spotPrice, interestRate, otherOption->bisectionImpliedVol);
+                j++;
             }
+            else
+            {
+                OptionData *otherOption = tickerData1->options[j++].get();
+                if (otherOption->implied_vol() > 0)
+                {
+                    // the model the IV was solved under (parity rate and dividend, the Black-76 forward of index
+                    // chains, early exercise) moved to this day's spot and maturity
+                    options[i]->calculate_bs_price(tickerData1->pricing_model(*options[i], spotPrice), otherOption->implied_vol());
+                }
+                i++;
+            }
+        }
+    };
 
-            // Move both indices forward
-            i++;
+    // both slice directories are sorted by expiration, so the expirations are merge-joined as well
+    const std::vector<ExpirySlice> &otherSlices = tickerData1->slices;
+    size_t j = 0;
+    for (const ExpirySlice &slice : slices)
+    {
+        while (j < otherSlices.size() && otherSlices[j].expiration < slice.expiration)
+        {
             j++;
         }
-        else
+        if (j == otherSlices.size())
         {
-            // If not matched, find the corresponding option in `tickerData1`
-            otherOption = tickerData1->findOption(myOption->strike, myOption->expiration, myOption->optionType);
-
-            if (otherOption && otherOption->bisectionImpliedVol > 0)
-            {
-                myOption->calculate_bs_price(spotPrice, interestRate, otherOption->bisectionImpliedVol);
-            }
-
-            // Move forward only the iterator for `this` Ticker
-            i++;
+            break;
+        }
+        if (otherSlices[j].expiration != slice.expiration)
+        {
+            continue;
         }
+
+        price_matches(slice.callBegin, slice.putBegin, otherSlices[j].callBegin, otherSlices[j].putBegin);
+        price_matches(slice.putBegin, slice.end, otherSlices[j].putBegin, otherSlices[j].end);
     }
 }
 
 // implentaion of write to csv all the option data (observed and calculated) of this Ticker
-void Ticker::write_to_csv(const std::string &filename) const
+void Ticker::write_to_csv(const std::string &filename, const CsvOptions &csvOptions) const
+{
+    if (write_options_csv(filename, tickerName, options, csvOptions))
+    {
+        std::cout << "CSV file written successfully: " << filename << std::endl;
+    }
+}
+
+// implementation of write to csv the parity residual of every call/put pair and the implied forward of its expiration
+void Ticker::write_parity_csv(const std::string &filename) const
 {
     std::ofstream file(filename);
     if (!file.is_open())
@@ -115,39 +409,26 @@ void Ticker::write_to_csv(const std::string &filename) const
     }
 
     // **Write CSV Header**
-    file << "Ticker,Expiration,TimeToMaturity,Strike,OptionType,LastPrice,"
-         << "Bid,Ask,Volume,OpenInterest,ImpliedVolatility,BisectionIV,BisectionTime,NewtonIV,NewtonTime,"
-         << "SecantIV,SecantTime,Delta_bs,Gamma_bs,Vega_bs,Delta_fd,Gamma_fd,Vega_fd,Parity_price,Bs_price,InTheMoney\n";
+    file << "Ticker,Expiration,TimeToMaturity,Strike,CallPrice,PutPrice,Residual,"
+         << "Forward,DiscountFactor,ImpliedRate,ImpliedDividend,Pairs,Robust\n";
 
-    // **Write Option Data**
-    for (const auto &option : options)
+    // **Write one row per call/put pair**
+    for (const auto &[call, put] : parityPairs)
     {
-        file << tickerName << "," // Add ticker symbol
-             << option->expiration << ","
-             << option->timeToMaturity << ","
-             << option->strike << ","
-             << option->optionType << ","
-             << option->lastPrice << ","
-             << option->bid << ","
-             << option->ask << ","
-             << option->volume << ","
-             << option->openInterest << ","
-             << option->impliedVolatility << ","
-             << option->bisectionImpliedVol << ","
-             << option->bisectionTime << ","
-             << option->newtonImpliedVol << ","
-             << option->newtonTime << ","
-             << option->secantImpliedVol << ","
-             << option->secantTime << ","
-             << option->delta_bs << ","
-             << option->gamma_bs << ","
-             << option->vega_bs << ","
-             << option->delta_fd << ","
-             << option->gamma_fd << ","
-             << option->vega_fd << ","
-             << option->parity_price << ","
-             << option->bs_price << ","
-             << (option->inTheMoney ? "True" : "False") << "\n";
+        const ParityFit *fit = findParityFit(call->expiration);
+        file << tickerName << ","
+             << call->expiration << ","
+             << call->timeToMaturity << ","
+             << call->strike << ","
+             << call->market_price() << ","
+             << put->market_price() << ","
+             << call->parity_residual << ","
+             << fit->forward << ","
+             << fit->discountFactor << ","
+             << fit->impliedRate << ","
+             << fit->impliedDividend << ","
+             << fit->pairs << ","
+             << (fit->robust ? "True" : "False") << "\n";
     }
 
     file.close();
@@ -1,8 +1,22 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
 #include "OptionData.h"
+#include "Parity.h"
+#include "IVCache.h"
+#include "CsvWriter.h"
+#include "BlackScholes.h"
+
+// contracts of one expiration in the sliced chain: the calls and then the puts, each sorted by strike,
+// are the contiguous ranges [callBegin, putBegin) and [putBegin, end) of Ticker::getOptions()
+struct ExpirySlice
+{
+    std::string expiration;
+    double timeToMaturity;
+    size_t callBegin, putBegin, end;
+};
 
 // class to store and manage options for a specific ticker
 class Ticker
@@ -11,7 +25,23 @@ private:
     std::string tickerName; // stock ticker symbol
     double spotPrice;
     double interestRate;
+    UnderlyingType underlyingType; // Index for yahoo index symbols (^VIX, ^SPX), Equity otherwise
     std::vector<std::unique_ptr<OptionData>> options; // unique ptr vector of OptionData
+    std::vector<ParityFit> parityFits;                 // implied forward per expiration, sorted by expiration
+    std::vector<std::pair<OptionData *, OptionData *>> parityPairs; // (call, put) pairs used in the parity fits
+    std::vector<ExpirySlice> slices; // slice directory, sorted by expiration
+    std::vector<double> strikes;     // strike of every contract in chain order, the binary search keys of the slices
+    size_t slicedContracts = 0;      // chain size when the slices were built, they are stale once contracts are added
+
+    bool slices_current() const { return slicedContracts == options.size(); }
+    // index of the contract with this strike in [begin, end) of a strike-sorted range, end if there is none
+    size_t find_strike(size_t begin, size_t end, double strike) const;
+
+    // solver of one expiration: batch(model, n, strikes, phis, prices, vols) with model the pricing model of
+    // the slice's first contract and phi 1 for calls, -1 for puts
+    using SliceSolver = std::function<void(const BlackScholes &, size_t, const double *, const double *, const double *, double *)>;
+    // solve every expiration of the chain with batch and write the vols into seeds in chain order
+    void solve_slices(const SliceSolver &batch, std::vector<double> &seeds) const;
 
 public:
     // constructor
@@ -26,15 +56,45 @@ public:
     // getter for spot price and interest rate
     double getSpotPrice() const { return spotPrice; };
     double getInterestRate() const { return interestRate; };
+    UnderlyingType getUnderlyingType() const { return underlyingType; }
+    // read access to the option chain
+    const std::vector<std::unique_ptr<OptionData>> &getOptions() const { return options; }
+
+    // reorder the chain into per-expiration slices (expirations sorted in parallel) and build the slice
+    // directory; the loader calls this once all contracts are added; the resulting order (expiration, then
+    // calls and puts by strike) is the layout of the options_data files, so output files keep their row order
+    void build_slices();
+    // the slice directory, empty until build_slices is called
+    const std::vector<ExpirySlice> &getSlices() const { return slices; }
+    // find the slice of an expiration, nullptr if there is none or the slices are stale
+    const ExpirySlice *findSlice(const std::string &expiration) const;
 
     // find and return a pointer to the OptionData that matches strike, expiration and type
     OptionData *findOption(double strike, const std::string &expiration, const std::string &optionType) const;
 
+    // find the parity fit of an expiration, nullptr if put-call parity has not been calculated for it
+    const ParityFit *findParityFit(const std::string &expiration) const;
+    const std::vector<ParityFit> &getParityFits() const { return parityFits; }
+    // rate and dividend the IV of a contract is solved with: the parity fit's implied values if there is one
+    void solver_inputs(const OptionData &option, double &rate, double &dividend) const;
+    // the model the IV of a contract is solved under at the given spot: Black-Scholes on the spot for
+    // equity chains (American under iv_settings().american), Black-76 on the expiration's forward for
+    // index chains
+    BlackScholes pricing_model(const OptionData &option, double spot) const;
+
     // functions to calculate the implied vol, greeks, parity price and bs price
-    void calculate_implied_vols_and_greeks();
+    // with a cache, unchanged contracts are loaded from it and changed ones warm-start from the cached IV;
+    // index chains are warm-started from a batch Black-76 solve of each expiration, American equity chains
+    // from a batch solve under their early exercise approximation
+    void calculate_implied_vols_and_greeks(IVCache *cache = nullptr);
+    void calculate_iv_and_greeks(OptionData &option, double spot, IVCache *cache = nullptr, double initialVol = 0) const; // one contract at the given spot
     void calculate_put_call_parity();
+    // price this day's contracts with the other day's IVs under the other day's pricing_model at this spot
     void calculate_bs_price_from_other_ticker(const std::unique_ptr<Ticker> &otherTicker);
 
     // function to write all options to a CSV file
-    void write_to_csv(const std::string &filename) const;
+    void write_to_csv(const std::string &filename, const CsvOptions &csvOptions = {}) const;
+
+    // function to write the parity residuals and implied forward of every call/put pair to a CSV file
+    void write_parity_csv(const std::string &filename) const;
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Build the release, lto and pgo-use presets (running the PGO training in between) and compare them on
+# the bundled chains: median wall time of the pricing pipeline and the solver benchmark throughput.
+#
+#   ./benchmark_builds.sh [runs]        # runs of the pipeline per build, default 10
+set -euo pipefail
+
+runs=${1:-10}
+cd "$(dirname "$0")"
+
+for preset in release lto pgo-generate; do
+    cmake --preset "$preset" >/dev/null
+    cmake --build --preset "$preset" >/dev/null
+done
+cmake --build --preset pgo-train >/dev/null
+cmake --preset pgo-use >/dev/null
+cmake --build --preset pgo-use >/dev/null
+
+scratch=$(mktemp -d)
+trap 'rm -rf "$scratch"' EXIT
+
+printf "%-10s %14s %18s %18s %18s\n" build "pipeline (ms)" "bisection (1/s)" "newton (1/s)" "secant (1/s)"
+for preset in release lto pgo-use; do
+    main="build/$preset/main"
+    times=()
+    for ((i = 0; i < runs; i++)); do
+        start=$(date +%s%N)
+        "$main" --stages parity,iv,greeks,reprice --output-dir "$scratch" >/dev/null
+        end=$(date +%s%N)
+        times+=($(((end - start) / 1000000)))
+    done
+    median=$(printf "%s\n" "${times[@]}" | sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }')
+
+    "$main" --stages parity,iv --format none --bench-solvers 50 --output-dir "$scratch" >/dev/null
+    throughput=$(awk -F, 'NR > 1 { printf "%18.0f ", $7 }' "$scratch/solver_report.csv")
+    printf "%-10s %14s %s\n" "$preset" "$median" "$throughput"
+done
@@ -1,4 +1,13 @@
 #include "Ticker.h"
+#include "Loader.h"
+#include "DumpLoader.h"
+#include "QuoteFeed.h"
+#include "LocalVol.h"
+#include "Heston.h"
+#include "Portfolio.h"
+#include "SolverBenchmark.h"
+#include "CommandLine.h"
+#include "Parallel.h"
 #include "util.h"
 #include <iostream>
 #include <functional>
@@ -6,103 +15,154 @@
 #include <algorithm>
 #include <string>
 #include <sstream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
 #include <unordered_map> // For fast lookup of existing tickers
+#include <filesystem>
 
 using namespace std;
 
-void read_csv_into_ticker_object(std::string fileName, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers)
+// reprice the chain under its Dupire local vol surface with the Crank-Nicolson pricer and
+// compare against the Black-Scholes price at each contract's own implied vol
+void reprice_with_local_vol(const Ticker &ticker, const std::string &fileName)
 {
-    ifstream ifile(fileName, ios::in);
-    if (!ifile.is_open())
+    auto start = chrono::steady_clock::now();
+    LocalVolSurface surface = LocalVolSurface::from_ticker(ticker);
+    if (surface.empty())
     {
-        cout << "Error opening file for input!" << endl;
+        cout << "not enough quotes to build a local vol surface for " << ticker.getTickerName() << endl;
         return;
     }
 
-    string line_;
-
-    // getting rid of headers
-    getline(ifile, line_);
-
-    while (getline(ifile, line_))
-    {
-        stringstream ss(line_);
-        string temp;
-
-        string ticker, expiration, optionType;
-        double timeToMaturity, strike, lastPrice, bid, ask, volume, openInterest, impliedVolatility, spotPrice, interestRate;
-        bool inTheMoney;
-
-        std::getline(ss, temp, ','); // Ignore first empty column
-        std::getline(ss, ticker, ',');
-        std::getline(ss, expiration, ',');
-        std::getline(ss, temp, ',');
-        timeToMaturity = std::stod(temp);
-        std::getline(ss, temp, ',');
-        strike = std::stod(temp);
-        std::getline(ss, optionType, ',');
-        std::getline(ss, temp, ',');
-        lastPrice = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        bid = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        ask = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        volume = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        openInterest = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        impliedVolatility = temp.empty() ? 0.0 : std::stod(temp);
-        std::getline(ss, temp, ',');
-        inTheMoney = (temp == "True");
-        std::getline(ss, temp, ',');
-        spotPrice = std::stod(temp);
-        std::getline(ss, temp, ',');
-        interestRate = std::stod(temp);
-        interestRate = interestRate / 100;
-
-        if (tickers.find(ticker) == tickers.end())
+    // contracts with a usable implied vol and two sided quotes
+    vector<const OptionData *> chain;
+    vector<PdeContract> contracts;
+    for (const auto &option : ticker.getOptions())
+    {
+        if (option->implied_vol() > 0.01 && option->implied_vol() < 2.5 && option->bid > 0 && option->ask > 0)
         {
-            tickers[ticker] = make_unique<Ticker>(ticker, spotPrice, interestRate);
+            const ParityFit *fit = ticker.findParityFit(option->expiration);
+            PayoffType payoffType = option->optionType == "Call" ? PayoffType::Call : PayoffType::Put;
+            chain.push_back(option.get());
+            contracts.push_back({option->strike, option->timeToMaturity, payoffType,
+                                 fit ? fit->impliedRate : ticker.getInterestRate(), fit ? fit->impliedDividend : 0.0});
         }
+    }
 
-        // Create a new OptionData object
-        auto option = std::make_unique<OptionData>(expiration, timeToMaturity, strike, optionType,
-                                                   lastPrice, bid, ask, volume, openInterest, impliedVolatility, inTheMoney);
+    CrankNicolsonPricer pricer(surface, ticker.getSpotPrice());
+    vector<double> pdePrices = pricer.price_all(contracts);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream file(fileName);
+    file << "Ticker,Expiration,Strike,OptionType,MarketPrice,BSPrice,PDEPrice,LocalVol\n";
+    // RMS difference over the out-of-the-money contracts the surface was fitted to
+    double sumSquares = 0;
+    size_t outOfTheMoney = 0;
+    for (size_t i = 0; i < chain.size(); ++i)
+    {
+        const PdeContract &contract = contracts[i];
+        BlackScholes bs(contract.strike, ticker.getSpotPrice(), contract.maturity, contract.interestRate,
+                        contract.payoffType, contract.dividendYield);
+        double bsPrice = bs(chain[i]->implied_vol());
+        const ParityFit *fit = ticker.findParityFit(chain[i]->expiration);
+        double forward = fit ? fit->forward : ticker.getSpotPrice();
+        if ((contract.payoffType == PayoffType::Call) == (contract.strike >= forward))
+        {
+            sumSquares += (pdePrices[i] - bsPrice) * (pdePrices[i] - bsPrice);
+            outOfTheMoney++;
+        }
 
-        // Add option data to the existing Ticker object
-        tickers[ticker]->addOptionData(std::move(option));
+        file << ticker.getTickerName() << ","
+             << chain[i]->expiration << ","
+             << chain[i]->strike << ","
+             << chain[i]->optionType << ","
+             << chain[i]->market_price() << ","
+             << bsPrice << ","
+             << pdePrices[i] << ","
+             << surface.local_vol(contract.maturity, contract.strike) << "\n";
     }
 
-    ifile.close();
+    cout << "local vol reprice of " << chain.size() << " " << ticker.getTickerName() << " contracts in " << seconds
+         << " s, RMS PDE - BS difference over OTM contracts " << sqrt(sumSquares / max<size_t>(outOfTheMoney, 1)) << endl;
 }
 
-int main()
+// aggregate a loaded book, print the totals of every ticker and write the bucket report
+void report_portfolio(Portfolio &portfolio, size_t loaded, const std::string &reportPath)
 {
+    auto start = chrono::steady_clock::now();
+    portfolio.aggregate();
+    double aggregateMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 
-    std::unordered_map<std::string, std::unique_ptr<Ticker>> tickers_data1; // Map to store unique tickers
+    for (const string &ticker : portfolio.ticker_names())
+    {
+        const RiskTotals &totals = portfolio.ticker_totals(ticker);
+        cout << "risk " << ticker << ": " << totals.positions << " positions, dollar delta " << totals.dollarDelta
+             << ", dollar gamma " << totals.dollarGamma << ", dollar vega " << totals.dollarVega << endl;
+    }
+    cout << "aggregated " << loaded << " positions in " << aggregateMillis << " ms" << endl;
+    portfolio.write_report(reportPath);
+}
 
-    std::unordered_map<std::string, std::unique_ptr<Ticker>> tickers_data2; // Another map to store Data2
+// replay quote updates on top of the day 1 chain and report the tick-to-IV latency
+int run_replay(const RunConfig &config)
+{
+    std::unordered_map<std::string, std::unique_ptr<Ticker>> tickers;
+    read_csv_into_ticker_object(config.input, tickers);
 
-    read_csv_into_ticker_object("options_data1.csv", tickers_data1);
+    for (const auto &[ticker, tickerObj] : tickers)
+    {
+        tickerObj->calculate_put_call_parity();
+        tickerObj->calculate_implied_vols_and_greeks();
+    }
 
-    read_csv_into_ticker_object("options_data2.csv", tickers_data2);
+    unsigned consumers = config.replayConsumers ? config.replayConsumers : max(2u, thread::hardware_concurrency()) - 1;
+    LatencyHistogram latency;
+    ReplayStats stats = replay_quotes(config.replaySource, tickers, consumers, latency);
 
-    // calculate implied vol, greeks, put-call parity for data1 and writing it into csv file
-    for (const auto &[ticker, tickerObj] : tickers_data1)
+    cout << "replayed " << stats.linesRead << " lines from " << config.replaySource << " with " << consumers << " consumers in "
+         << stats.seconds << " s: decoded " << stats.decoded << ", processed " << stats.processed
+         << ", unmatched " << stats.unmatched << ", stale " << stats.stale << ", dropped " << stats.dropped << "\n";
+    cout << latency;
+
+    if (config.format != "none")
     {
-        cout << "ticker name: " << tickerObj->getTickerName() << " no of options: " << tickerObj->getOptionsSize() << endl;
-        tickerObj->calculate_implied_vols_and_greeks();
-        tickerObj->calculate_put_call_parity();
-        string outputFileName = ticker + "_outputData1.csv";
-        tickerObj->write_to_csv(outputFileName);
+        for (const auto &[ticker, tickerObj] : tickers)
+        {
+            tickerObj->write_to_csv(config.chain_path(ticker, "replayData"), config.csv);
+        }
+    }
+    return 0;
+}
 
-        // for each ticker calculate the option price using calculated implied volatitlity from previous day
-        tickers_data2[ticker]->calculate_bs_price_from_other_ticker(tickerObj);
-        outputFileName = ticker + "_outputData2.csv";
-        tickers_data2[ticker]->write_to_csv(outputFileName);
+// compare the root finders over the day 1 chains and write the solver report
+void run_solver_benchmark(const std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers, int repetitions,
+                          const std::string &reportPath)
+{
+    // walk the tickers in name order so the contract order, and with it the report, is the same every run
+    std::vector<const Ticker *> chains;
+    for (const auto &[name, ticker] : tickers)
+    {
+        chains.push_back(ticker.get());
     }
+    std::sort(chains.begin(), chains.end(), [](const Ticker *a, const Ticker *b)
+              { return a->getTickerName() < b->getTickerName(); });
+
+    SolverBenchmarkConfig config;
+    config.repetitions = repetitions;
+    std::vector<SolverStats> stats = benchmark_solvers(chains, config);
+    for (const SolverStats &s : stats)
+    {
+        cout << s.solver << ": " << s.solvesPerSecond << " solves/s (median of " << s.repetitions << " passes over "
+             << s.contracts << " contracts), " << s.meanIterations << " mean / " << s.maxIterations << " max iterations, "
+             << s.failures << " failures (" << 100 * s.failureRate << "%), max |IV error| " << s.maxAbsError << endl;
+    }
+    write_solver_report(reportPath, stats);
+}
 
+// numerical integration of sin(x) / x with the trapezoidal and Simpson's rules and double integrals
+void run_integration()
+{
     // part iii numerical integration using Trapezoidal and Simpsons Rule
 
     // defining the real valued function presetned in the question
@@ -176,6 +236,223 @@ int main()
                   << std::setw(20) << std::fixed << std::setprecision(6) << std::abs(f2_integral - f2_value)
                   << std::endl;
     }
+}
+
+// fit the Heston model to the whole chain
+void fit_heston(const Ticker &ticker)
+{
+    HestonCalibration heston = calibrate_heston(ticker);
+    if (!heston.failure.empty())
+    {
+        cout << "heston fit of " << heston.quotes << " " << ticker.getTickerName() << " quotes failed in " << heston.seconds
+             << " s (" << heston.evaluations << " evaluations): " << heston.failure << ", rmse " << heston.rmse << endl;
+        return;
+    }
+    cout << "heston fit of " << heston.quotes << " " << ticker.getTickerName() << " quotes in " << heston.seconds << " s ("
+         << heston.evaluations << " evaluations): kappa " << heston.params.kappa << " theta " << heston.params.theta
+         << " sigma " << heston.params.sigma << " rho " << heston.params.rho << " v0 " << heston.params.v0
+         << " rmse " << heston.rmse << endl;
+}
+
+// load an options_data csv, or a directory of per-expiration chain dumps
+void read_chains(const string &path, std::unordered_map<std::string, std::unique_ptr<Ticker>> &tickers)
+{
+    if (filesystem::is_directory(path))
+    {
+        auto start = chrono::steady_clock::now();
+        size_t contracts = read_chain_dump_directory(path, tickers);
+        cout << "read " << contracts << " contracts from the dumps in " << path << " in "
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+        return;
+    }
+    read_csv_into_ticker_object(path, tickers);
+}
+
+void read_compact_chains(const string &path, std::unordered_map<std::string, CompactChain> &chains, bool diagnostics)
+{
+    if (!filesystem::is_directory(path))
+    {
+        read_csv_into_compact_chains(path, chains, diagnostics);
+        return;
+    }
+    auto start = chrono::steady_clock::now();
+    size_t contracts = read_chain_dump_directory(path, chains, diagnostics);
+    cout << "read " << contracts << " contracts from the dumps in " << path << " in "
+         << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+}
+
+// calculate put-call parity, implied vol and greeks of one ticker and write them into csv files, then
+// reprice it and price its next-day chain from the solved IVs
+void process_ticker(const RunConfig &config, const string &ticker, const unique_ptr<Ticker> &tickerObj, Ticker *nextDay,
+                    IVCache *cache)
+{
+    bool writeChains = config.format != "none";
+    cout << "ticker name: " << tickerObj->getTickerName() << " no of options: " << tickerObj->getOptionsSize() << endl;
+    // fit the implied forwards first so the IV solve prices off them
+    if (config.has(StageParity))
+    {
+        tickerObj->calculate_put_call_parity();
+    }
+    if (config.has(StageIV))
+    {
+        tickerObj->calculate_implied_vols_and_greeks(cache);
+    }
+    if (writeChains)
+    {
+        tickerObj->write_to_csv(config.chain_path(ticker, "outputData1"), config.csv);
+    }
+    if (config.has(StageParity))
+    {
+        tickerObj->write_parity_csv(config.output_path(ticker + "_parityData1.csv"));
+    }
+
+    if (config.has(StageReprice))
+    {
+        reprice_with_local_vol(*tickerObj, config.output_path(ticker + "_localVolData1.csv"));
+        fit_heston(*tickerObj);
+
+        // for each ticker calculate the option price using calculated implied volatitlity from previous day
+        if (nextDay)
+        {
+            nextDay->calculate_bs_price_from_other_ticker(tickerObj);
+            if (writeChains)
+            {
+                nextDay->write_to_csv(config.chain_path(ticker, "outputData2"), config.csv);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    RunConfig config;
+    string error;
+    if (!parse_command_line(argc, argv, config, error))
+    {
+        cerr << "Error: " << error << endl;
+        print_usage(cerr, argv[0]);
+        return 2;
+    }
+    if (config.help)
+    {
+        print_usage(cout, argv[0]);
+        return 0;
+    }
+
+    set_parallel_threads(config.threads);
+    set_iv_settings(config.iv);
+
+    // live ingestion mode: replay quote updates on top of the input chain
+    if (!config.replaySource.empty())
+    {
+        return run_replay(config);
+    }
+
+    std::unique_ptr<IVCache> cache;
+    if (!config.cachePath.empty() && config.has(StageIV))
+    {
+        cache = make_unique<IVCache>(config.cachePath);
+    }
+
+    std::unordered_map<std::string, std::unique_ptr<Ticker>> tickers_data1; // Map to store unique tickers
+
+    std::unordered_map<std::string, std::unique_ptr<Ticker>> tickers_data2; // Another map to store Data2
+
+    bool nextDay = config.has(StageReprice) && !config.nextDayInput.empty();
+
+    if (config.compact)
+    {
+        // the chains stay compact and are expanded one ticker at a time
+        std::unordered_map<std::string, CompactChain> compact_data1, compact_data2;
+        read_compact_chains(config.input, compact_data1, config.compactDiagnostics);
+        if (nextDay)
+        {
+            read_compact_chains(config.nextDayInput, compact_data2, config.compactDiagnostics);
+        }
+
+        // the book takes each ticker's greeks while it is expanded, so no chain is expanded twice
+        bool book = !config.positionsPath.empty() && config.has(StageGreeks);
+        Portfolio portfolio;
+        vector<PositionRow> positions;
+        size_t loaded = 0;
+        if (book)
+        {
+            positions = Portfolio::read_positions(config.positionsPath);
+        }
+
+        size_t contracts = 0, bytes = 0;
+        for (auto &[ticker, chain] : compact_data1)
+        {
+            unique_ptr<Ticker> tickerObj = chain.to_ticker();
+            unique_ptr<Ticker> nextObj;
+            auto next = compact_data2.find(ticker);
+            if (next != compact_data2.end())
+            {
+                nextObj = next->second.to_ticker();
+            }
+            process_ticker(config, ticker, tickerObj, nextObj.get(), cache.get());
+            chain.store_results(*tickerObj);
+            if (book)
+            {
+                loaded += portfolio.add_positions(positions, *tickerObj);
+                portfolio.release_ticker(ticker);
+            }
+            if (nextObj)
+            {
+                next->second.store_results(*nextObj);
+            }
+            contracts += chain.size();
+            bytes += chain.memory_bytes();
+        }
+        cout << "compact chains: " << contracts << " contracts in " << bytes << " bytes ("
+             << (contracts ? bytes / contracts : 0) << " per contract)" << endl;
+
+        if (book)
+        {
+            if (loaded < positions.size())
+            {
+                cerr << "Warning: skipped " << positions.size() - loaded << " positions in contracts that are not loaded" << endl;
+            }
+            report_portfolio(portfolio, loaded, config.output_path("portfolio_risk.csv"));
+        }
+    }
+    else
+    {
+        read_chains(config.input, tickers_data1);
+        if (nextDay)
+        {
+            read_chains(config.nextDayInput, tickers_data2);
+        }
+
+        for (const auto &[ticker, tickerObj] : tickers_data1)
+        {
+            auto next = tickers_data2.find(ticker);
+            process_ticker(config, ticker, tickerObj, next != tickers_data2.end() ? next->second.get() : nullptr, cache.get());
+        }
+
+        if (!config.positionsPath.empty() && config.has(StageGreeks))
+        {
+            Portfolio portfolio;
+            size_t loaded = portfolio.load_positions(config.positionsPath, tickers_data1);
+            report_portfolio(portfolio, loaded, config.output_path("portfolio_risk.csv"));
+        }
+    }
+
+    if (config.benchRepetitions > 0)
+    {
+        run_solver_benchmark(tickers_data1, config.benchRepetitions, config.output_path("solver_report.csv"));
+    }
+
+    if (cache)
+    {
+        cout << "IV cache: " << cache->stats.hits << " hits, " << cache->stats.warmStarts << " warm starts, "
+             << cache->stats.misses << " misses, " << cache->size() << " contracts stored" << endl;
+    }
+
+    if (config.has(StageIntegrate))
+    {
+        run_integration();
+    }
 
     return 0;
-}
\ No newline at end of file
+}
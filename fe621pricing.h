@@ -0,0 +1,28 @@
+#pragma once
+// public header set of the fe621pricing library; include this or the individual headers below
+
+// pricing models and root finders
+#include "BlackScholes.h"
+#include "American.h"
+#include "BatchIV.h"
+#include "util.h"
+
+// option chains, loading and output
+#include "OptionData.h"
+#include "CompactChain.h"
+#include "Ticker.h"
+#include "Loader.h"
+#include "DumpLoader.h"
+#include "Parity.h"
+#include "CsvWriter.h"
+#include "IVCache.h"
+
+// models and risk built on solved chains
+#include "LocalVol.h"
+#include "Heston.h"
+#include "Portfolio.h"
+
+// quote replay, solver benchmark and threading helpers
+#include "QuoteFeed.h"
+#include "SolverBenchmark.h"
+#include "Parallel.h"
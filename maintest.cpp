@@ -1,10 +1,10 @@
-#include "util.h"
+#include "fe621pricing.h"
 #include <iostream>
 
 using namespace std;
 
-// Function to test Normal CDF against Z-table values
-void test_norm_cdf()
+// Function to test Normal CDF against Z-table values, returns the number of failures
+int test_norm_cdf()
 {
     std::cout << "Testing norm_cdf against Z-table values:\n";
 
@@ -30,6 +30,7 @@ void test_norm_cdf()
         {-2.5, 0.0062},
         {-3.0, 0.0013}};
 
+    int failures = 0;
     for (const auto &test : testCases)
     {
         double computed_cdf = norm_cdf(test.z);
@@ -38,11 +39,14 @@ void test_norm_cdf()
                   << " | Expected CDF = " << test.expected_cdf
                   << " | Error = " << std::fabs(computed_cdf - test.expected_cdf)
                   << "\n";
+        // the table is rounded to 4 digits
+        failures += std::fabs(computed_cdf - test.expected_cdf) > 1e-4;
     }
+    return failures;
 }
 
-// Function to test Normal PDF values
-void test_norm_pdf()
+// Function to test Normal PDF values, returns the number of failures
+int test_norm_pdf()
 {
     std::cout << "\nTesting norm_pdf:\n";
 
@@ -68,6 +72,7 @@ void test_norm_pdf()
         {-2.5, 0.01753},
         {-3.0, 0.00443}};
 
+    int failures = 0;
     for (const auto &test : testCases)
     {
         double computed_pdf = norm_pdf(test.x);
@@ -76,15 +81,45 @@ void test_norm_pdf()
                   << " | Expected PDF = " << test.expected_pdf
                   << " | Error = " << std::fabs(computed_pdf - test.expected_pdf)
                   << "\n";
+        // the expected values are rounded to 5 digits
+        failures += std::fabs(computed_pdf - test.expected_pdf) > 1e-5;
     }
+    return failures;
+}
+
+// Function to test that the three solvers recover the vol a price was made with, returns the number of failures
+int test_implied_vol_solvers()
+{
+    std::cout << "\nTesting implied vol solvers:\n";
+
+    int failures = 0;
+    for (PayoffType type : {PayoffType::Call, PayoffType::Put})
+    {
+        for (double strike : {80.0, 100.0, 120.0})
+        {
+            BlackScholes bs(strike, 100, 0.5, 0.04, type, 0.01);
+            double price = bs(0.3);
+            // Newton overshoots from the default guess of 2 on out-of-the-money strikes, so the
+            // open methods start from 0.5 here
+            double ivs[] = {bisection_method(bs, price), newton_method(bs, price, 0.5), secant_method(bs, price, 0.5)};
+            std::cout << (type == PayoffType::Call ? "Call" : "Put") << " K = " << strike
+                      << " | Bisection = " << ivs[0] << " | Newton = " << ivs[1] << " | Secant = " << ivs[2] << "\n";
+            for (double iv : ivs)
+            {
+                failures += std::fabs(iv - 0.3) > 1e-4;
+            }
+        }
+    }
+    return failures;
 }
 
 int main()
 {
 
-    // testing the implemntation of norm_cdf and norm_pdf
-    test_norm_cdf();
-    test_norm_pdf();
+    // testing the implemntation of norm_cdf and norm_pdf and the IV solvers
+    int failures = test_norm_cdf() + test_norm_pdf() + test_implied_vol_solvers();
 
-    return 0;
-}
\ No newline at end of file
+    std::cout << "\n"
+              << failures << " failures\n";
+    return failures == 0 ? 0 : 1;
+}
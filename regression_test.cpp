@@ -0,0 +1,860 @@
+#include "fe621pricing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// correctness regression suite: the golden test runs the pipeline on the bundled chains and compares the
+// chain files against golden/ with per-column tolerances, the property tests check model identities that
+// hold whatever the implementation; every test returns its number of failures
+//
+//   regression_test [golden|properties|all] [--data-dir <dir>] [--golden-dir <dir>] [--output-dir <dir>] [--update]
+//
+// --update rewrites the golden files from the current build, review the diff before committing them
+
+namespace
+{
+    // how a chain file column is compared against the golden file
+    enum class Compare
+    {
+        Exact,    // quote data read from the input, must be unchanged
+        Numeric,  // |value - golden| <= abs + rel * |golden|
+        SolverIV, // Numeric where the golden IV is inside the solver bracket, skipped where the solver diverged
+        Ignored   // wall clock timings
+    };
+
+    struct ColumnTolerance
+    {
+        const char *column;
+        Compare compare;
+        double abs;
+        double rel;
+    };
+
+    // the solvers stop on a price residual of 1e-6, so an IV may move by about 1e-6 / vega when the
+    // iteration path changes (a different erf, reassociated arithmetic); the tolerances allow for that and
+    // for the cancellation noise of the finite difference greeks (h = 1e-4: ~1e-8 in delta and vega,
+    // ~1e-5 in gamma), but catch any change of the models themselves
+    const ColumnTolerance tolerances[] = {
+        {"Ticker", Compare::Exact, 0, 0},
+        {"Expiration", Compare::Exact, 0, 0},
+        {"TimeToMaturity", Compare::Exact, 0, 0},
+        {"Strike", Compare::Exact, 0, 0},
+        {"OptionType", Compare::Exact, 0, 0},
+        {"LastPrice", Compare::Exact, 0, 0},
+        {"Bid", Compare::Exact, 0, 0},
+        {"Ask", Compare::Exact, 0, 0},
+        {"Volume", Compare::Exact, 0, 0},
+        {"OpenInterest", Compare::Exact, 0, 0},
+        {"ImpliedVolatility", Compare::Numeric, 1e-6, 1e-6}, // solved by the next-day reprice in outputData2
+        {"BisectionIV", Compare::SolverIV, 1e-4, 0},
+        {"BisectionTime", Compare::Ignored, 0, 0},
+        {"NewtonIV", Compare::SolverIV, 1e-4, 0},
+        {"NewtonTime", Compare::Ignored, 0, 0},
+        {"SecantIV", Compare::SolverIV, 1e-4, 0},
+        {"SecantTime", Compare::Ignored, 0, 0},
+        {"Delta_bs", Compare::Numeric, 1e-5, 1e-4},
+        {"Gamma_bs", Compare::Numeric, 1e-6, 1e-3},
+        {"Vega_bs", Compare::Numeric, 1e-3, 1e-4},
+        {"Delta_fd", Compare::Numeric, 1e-5, 1e-4},
+        {"Gamma_fd", Compare::Numeric, 1e-4, 1e-3},
+        {"Vega_fd", Compare::Numeric, 1e-3, 1e-4},
+        {"Parity_price", Compare::Numeric, 1e-6, 1e-9},
+        {"Bs_price", Compare::Numeric, 1e-4, 1e-6},
+        {"InTheMoney", Compare::Exact, 0, 0},
+    };
+
+    // bracket of bisection_method, IVs outside it are a solver that did not converge
+    constexpr double minIV = 1e-4;
+    constexpr double maxIV = 3.0;
+
+    struct Paths
+    {
+        string dataDir = ".";
+        string goldenDir = "golden";
+        string outputDir = "regression_output";
+        bool update = false;
+    };
+
+    using Tickers = unordered_map<string, unique_ptr<Ticker>>;
+
+    // the default pipeline of main: parity fits, IVs and greeks of day 1, day 2 priced from the day 1 IVs
+    void run_pipeline(const Paths &paths, Tickers &day1, Tickers &day2)
+    {
+        read_csv_into_ticker_object(paths.dataDir + "/options_data1.csv", day1);
+        read_csv_into_ticker_object(paths.dataDir + "/options_data2.csv", day2);
+        for (const auto &[name, ticker] : day1)
+        {
+            ticker->calculate_put_call_parity();
+            ticker->calculate_implied_vols_and_greeks();
+            auto next = day2.find(name);
+            if (next != day2.end())
+            {
+                next->second->calculate_bs_price_from_other_ticker(ticker);
+            }
+        }
+    }
+
+    struct CsvTable
+    {
+        vector<string> header;
+        vector<vector<string>> rows;
+    };
+
+    bool read_table(const string &fileName, CsvTable &table)
+    {
+        ifstream file(fileName);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        string line;
+        bool first = true;
+        while (getline(file, line))
+        {
+            vector<string> fields;
+            stringstream ss(line);
+            string field;
+            while (getline(ss, field, ','))
+            {
+                fields.push_back(field);
+            }
+            if (first)
+            {
+                table.header = move(fields);
+                first = false;
+            }
+            else
+            {
+                table.rows.push_back(move(fields));
+            }
+        }
+        return !first;
+    }
+
+    const ColumnTolerance *find_tolerance(const string &column)
+    {
+        for (const ColumnTolerance &tolerance : tolerances)
+        {
+            if (column == tolerance.column)
+                return &tolerance;
+        }
+        return nullptr;
+    }
+
+    // compare a chain file with its golden file row by row, rows are matched on expiration, strike and type
+    int compare_chain_file(const string &fileName, const string &goldenName)
+    {
+        CsvTable actual, golden;
+        if (!read_table(goldenName, golden))
+        {
+            cout << "missing golden file " << goldenName << ", run regression_test --update\n";
+            return 1;
+        }
+        if (!read_table(fileName, actual))
+        {
+            cout << "missing output file " << fileName << "\n";
+            return 1;
+        }
+        if (actual.header != golden.header)
+        {
+            cout << fileName << ": header differs from the golden file\n";
+            return 1;
+        }
+
+        // column indices of the row key and the tolerance of every column
+        auto index = [&golden](const char *column)
+        { return find(golden.header.begin(), golden.header.end(), column) - golden.header.begin(); };
+        size_t expiration = index("Expiration"), strike = index("Strike"), type = index("OptionType");
+        vector<const ColumnTolerance *> columns;
+        for (const string &column : golden.header)
+        {
+            const ColumnTolerance *tolerance = find_tolerance(column);
+            if (!tolerance)
+            {
+                cout << fileName << ": no tolerance for column " << column << "\n";
+                return 1;
+            }
+            columns.push_back(tolerance);
+        }
+
+        auto key = [&](const vector<string> &row)
+        { return row[expiration] + "|" + row[strike] + "|" + row[type]; };
+        unordered_map<string, const vector<string> *> actualRows;
+        for (const auto &row : actual.rows)
+        {
+            if (row.size() == golden.header.size())
+                actualRows.emplace(key(row), &row);
+        }
+
+        int failures = 0;
+        size_t reported = 0;
+        auto fail = [&](const string &message)
+        {
+            failures++;
+            if (reported++ < 20)
+                cout << fileName << ": " << message << "\n";
+        };
+
+        if (actual.rows.size() != golden.rows.size())
+        {
+            fail(to_string(actual.rows.size()) + " rows, golden file has " + to_string(golden.rows.size()));
+        }
+        for (const auto &goldenRow : golden.rows)
+        {
+            auto it = actualRows.find(key(goldenRow));
+            if (it == actualRows.end())
+            {
+                fail("missing row " + key(goldenRow));
+                continue;
+            }
+            const vector<string> &row = *it->second;
+            for (size_t c = 0; c < columns.size(); ++c)
+            {
+                const ColumnTolerance &tolerance = *columns[c];
+                if (tolerance.compare == Compare::Ignored || row[c] == goldenRow[c])
+                    continue;
+                if (tolerance.compare == Compare::Exact)
+                {
+                    fail(key(goldenRow) + " " + tolerance.column + " = " + row[c] + ", golden " + goldenRow[c]);
+                    continue;
+                }
+
+                double value = stod(row[c]), expected = stod(goldenRow[c]);
+                if (tolerance.compare == Compare::SolverIV && !(expected > minIV && expected < maxIV))
+                    continue;
+                double error = abs(value - expected);
+                if (!(error <= tolerance.abs + tolerance.rel * abs(expected)))
+                {
+                    fail(key(goldenRow) + " " + tolerance.column + " = " + row[c] + ", golden " + goldenRow[c] +
+                         ", error " + to_string(error));
+                }
+            }
+        }
+        if (reported > 20)
+        {
+            cout << fileName << ": " << reported - 20 << " more differences\n";
+        }
+        return failures;
+    }
+
+    int test_golden(const Paths &paths)
+    {
+        cout << "Golden chain files:\n";
+        Tickers day1, day2;
+        run_pipeline(paths, day1, day2);
+
+        // write with shortest round-trip digits so the comparison sees every bit of the result
+        string directory = paths.update ? paths.goldenDir : paths.outputDir;
+        filesystem::create_directories(directory);
+        vector<string> files;
+        for (const auto &[name, ticker] : day1)
+        {
+            ticker->write_to_csv(directory + "/" + name + "_outputData1.csv");
+            files.push_back(name + "_outputData1.csv");
+        }
+        for (const auto &[name, ticker] : day2)
+        {
+            ticker->write_to_csv(directory + "/" + name + "_outputData2.csv");
+            files.push_back(name + "_outputData2.csv");
+        }
+        sort(files.begin(), files.end());
+
+        if (paths.update)
+        {
+            for (const auto &file : files)
+                cout << "updated " << paths.goldenDir << "/" << file << "\n";
+            return 0;
+        }
+
+        int failures = 0;
+        for (const auto &file : files)
+        {
+            int fileFailures = compare_chain_file(paths.outputDir + "/" + file, paths.goldenDir + "/" + file);
+            cout << file << ": " << fileFailures << " differences\n";
+            failures += fileFailures;
+        }
+        // a ticker dropped from the output fails here as well
+        for (const auto &entry : filesystem::directory_iterator(paths.goldenDir))
+        {
+            string name = entry.path().filename().string();
+            if (entry.path().extension() == ".csv" && find(files.begin(), files.end(), name) == files.end())
+            {
+                cout << "no output for golden file " << name << "\n";
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    // model grid of the property tests: moneyness, maturities and vols from the short-dated wings to long-dated
+    // high vol, under both Black-Scholes with a dividend yield and Black-76
+    template <typename Body>
+    void for_each_model(Body body)
+    {
+        for (PayoffType type : {PayoffType::Call, PayoffType::Put})
+            for (double strike : {60.0, 80.0, 95.0, 100.0, 105.0, 120.0, 150.0})
+                for (double T : {0.02, 0.25, 1.0, 3.0})
+                {
+                    body(BlackScholes(strike, 100, T, 0.04, type, 0.015));
+                    body(BlackScholes::black76(strike, 100, T, 0.04, type));
+                }
+    }
+
+    // C - P = S e^(-qT) - K e^(-rT) under the model, and over every solved pair of the bundled chains
+    // C - P = D (F - K) to within the residuals of the parity fit
+    int test_put_call_parity()
+    {
+        cout << "\nPut-call parity:\n";
+        int failures = 0;
+        size_t checked = 0;
+        for_each_model([&](const BlackScholes &model)
+                       {
+            if (model.get_payoff_type() == PayoffType::Put)
+                return;
+            double S = model.get_spot(), K = model.get_strike(), T = model.get_time_to_maturity();
+            double r = model.get_interest_rate(), q = model.get_dividend_yield();
+            BlackScholes put(K, S, T, r, PayoffType::Put, q);
+            for (double vol : {0.05, 0.2, 0.6, 1.5})
+            {
+                double spread = model(vol) - put(vol);
+                double forward = S * exp(-q * T) - K * exp(-r * T);
+                checked++;
+                if (abs(spread - forward) > 1e-10 * S)
+                {
+                    failures++;
+                    cout << "K = " << K << " T = " << T << " vol = " << vol << " | C - P = " << spread
+                         << " | forward value = " << forward << "\n";
+                }
+            } });
+        cout << checked << " model checks, " << failures << " failures\n";
+        return failures;
+    }
+
+    // the finite difference greeks of the solved chains agree with the analytic ones wherever the IV solved
+    // and the contract is not within a day of expiry, where the spot bump of 1e-4 no longer resolves gamma
+    int test_greeks_fd_vs_analytic(const Tickers &day1)
+    {
+        cout << "\nFinite difference vs analytic greeks:\n";
+        int failures = 0;
+        size_t checked = 0;
+        double maxDelta = 0, maxGamma = 0, maxVega = 0;
+        for (const auto &[name, ticker] : day1)
+        {
+            for (const auto &option : ticker->getOptions())
+            {
+                double vol = option->implied_vol();
+                if (!(vol > minIV && vol < maxIV) || option->timeToMaturity < 1.0 / 365)
+                    continue;
+                checked++;
+                double deltaError = abs(option->delta_fd - option->delta_bs);
+                double gammaError = abs(option->gamma_fd - option->gamma_bs);
+                double vegaError = abs(option->vega_fd - option->vega_bs);
+                maxDelta = max(maxDelta, deltaError);
+                maxGamma = max(maxGamma, gammaError);
+                maxVega = max(maxVega, vegaError);
+                if (deltaError > 1e-6 || gammaError > 1e-4 || vegaError > 1e-4 * max(1.0, option->vega_bs))
+                {
+                    failures++;
+                    if (failures <= 20)
+                        cout << name << " " << option->expiration << " " << option->strike << " " << option->optionType
+                             << " | delta " << option->delta_bs << " vs " << option->delta_fd
+                             << " | gamma " << option->gamma_bs << " vs " << option->gamma_fd
+                             << " | vega " << option->vega_bs << " vs " << option->vega_fd << "\n";
+                }
+            }
+        }
+        cout << checked << " contracts, max error delta " << maxDelta << " gamma " << maxGamma << " vega " << maxVega
+             << ", " << failures << " failures\n";
+        return failures;
+    }
+
+    // price -> IV -> price: every solver reprices to within 1e-5 (bisection stops on a residual of 1e-6 and
+    // returns the midpoint of its last bracket, one half step further) and recovers the vol itself wherever
+    // vega is large enough for the price to pin it down; Newton and secant are only locally convergent
+    // (Newton diverges from the default guess of 2 on out-of-the-money strikes, see maintest), so they
+    // start 25% off the root
+    int test_solver_round_trip()
+    {
+        cout << "\nSolver round trip price -> IV -> price:\n";
+        int failures = 0;
+        size_t checked = 0;
+        for_each_model([&](BlackScholes model)
+                       {
+            for (double vol : {0.05, 0.2, 0.6, 1.5})
+            {
+                double price = model(vol);
+                // below the bracket's lowest price no vol reproduces the price
+                if (price - model(minIV) < 1e-6)
+                    continue;
+                double vega = model.get_vega(vol);
+                const pair<const char *, double> ivs[] = {{"bisection", bisection_method(model, price)},
+                                                          {"newton", newton_method(model, price, 1.25 * vol)},
+                                                          {"secant", secant_method(model, price, 1.25 * vol)}};
+                for (const auto &[solver, iv] : ivs)
+                {
+                    checked++;
+                    double priceError = abs(model(iv) - price);
+                    bool volError = vega > 0.1 && abs(iv - vol) > 1e-4;
+                    if (!(priceError <= 1e-5) || volError)
+                    {
+                        failures++;
+                        cout << solver << " K = " << model.get_strike() << " T = " << model.get_time_to_maturity()
+                             << " vol = " << vol << " | IV = " << iv << " | price error = " << priceError << "\n";
+                    }
+                }
+            } });
+        cout << checked << " solves, " << failures << " failures\n";
+        return failures;
+    }
+
+    // Heston call prices from the original P1 / P2 probabilities (Albrecher's form of the characteristic
+    // function) by composite Simpson on a fine uniform grid, independent of the Lewis formula and the
+    // Filon grids of HestonPricer
+    vector<double> heston_reference_calls(double S, double r, double T, const HestonParams &p, const vector<double> &strikes)
+    {
+        using cd = complex<double>;
+        const cd i(0.0, 1.0);
+        double sigma2 = p.sigma * p.sigma;
+        auto cf = [&](double u, double b, double phi)
+        {
+            cd a = b - p.rho * p.sigma * i * phi;
+            cd d = sqrt(a * a - sigma2 * (2.0 * u * i * phi - phi * phi));
+            cd g = (a - d) / (a + d), e = exp(-d * T);
+            cd C = r * T * i * phi + p.kappa * p.theta / sigma2 * ((a - d) * T - 2.0 * log((1.0 - g * e) / (1.0 - g)));
+            cd D = (a - d) / sigma2 * (1.0 - e) / (1.0 - g * e);
+            return exp(C + D * p.v0 + i * phi * log(S));
+        };
+
+        // out to where both characteristic functions are below 1e-14
+        double step = 0.01, end = 8;
+        while (end < 16384 && (abs(cf(0.5, p.kappa - p.rho * p.sigma, end)) > 1e-14 || abs(cf(-0.5, p.kappa, end)) > 1e-14))
+            end *= 2;
+        size_t n = static_cast<size_t>(end / step);
+        vector<double> p1(strikes.size(), 0.0), p2(strikes.size(), 0.0);
+        for (size_t k = 0; k <= n; ++k)
+        {
+            double phi = k == 0 ? 1e-10 : k * step; // the integrands have a finite limit at 0
+            double weight = (k == 0 || k == n) ? 1 : (k % 2 ? 4 : 2);
+            cd f1 = cf(0.5, p.kappa - p.rho * p.sigma, phi) / (i * phi), f2 = cf(-0.5, p.kappa, phi) / (i * phi);
+            for (size_t j = 0; j < strikes.size(); ++j)
+            {
+                cd phase = exp(-i * phi * log(strikes[j]));
+                p1[j] += weight * (phase * f1).real();
+                p2[j] += weight * (phase * f2).real();
+            }
+        }
+        vector<double> calls(strikes.size());
+        for (size_t j = 0; j < strikes.size(); ++j)
+        {
+            double P1 = 0.5 + p1[j] * step / 3 / numbers::pi, P2 = 0.5 + p2[j] * step / 3 / numbers::pi;
+            calls[j] = S * P1 - strikes[j] * exp(-r * T) * P2;
+        }
+        return calls;
+    }
+
+    // HestonPricer against the reference where short maturities, high vol of vol and rho near -1 make the
+    // characteristic function decay slowly, plus the no-arbitrage bounds of every price; the parameter sets
+    // inside the calibration box are priced off a grid sized for the whole box as well
+    int test_heston_reference()
+    {
+        cout << "\nHeston pricer vs reference:\n";
+        int failures = 0;
+        size_t checked = 0;
+        double maxError = 0;
+        const double S = 100, r = 0.03;
+        const vector<double> strikes = {70, 90, 100, 110, 130};
+        const HestonParams boxLower = {0.1, 1e-3, 0.05, -0.95, 1e-3}, boxUpper = {20.0, 4.0, 5.0, 0.95, 4.0};
+        const pair<HestonParams, double> cases[] = {
+            {{0.5, 0.09, 1.0, -0.9, 0.02}, 0.5}, {{0.5, 0.09, 1.0, -0.9, 0.02}, 2.0},
+            {{50, 0.032, 7.24, -0.66, 0.0087}, 0.02}, {{50, 0.032, 7.24, -0.66, 0.0087}, 0.5},
+            {{1.0, 0.1, 2.5, -0.95, 0.05}, 1.0}, {{2.0, 0.04, 0.5, -0.6, 0.04}, 0.25}};
+        for (const auto &[params, T] : cases)
+        {
+            double F = S * exp(r * T), D = exp(-r * T);
+            HestonPricer pricer(T, F, D);
+            pricer.set_strikes(strikes);
+            pricer.set_params(params);
+            vector<double> calls, puts;
+            pricer.price_strikes(vector<PayoffType>(strikes.size(), PayoffType::Call), calls);
+            pricer.price_strikes(vector<PayoffType>(strikes.size(), PayoffType::Put), puts);
+            vector<double> reference = heston_reference_calls(S, r, T, params, strikes);
+            if (params.kappa <= boxUpper.kappa)
+            {
+                HestonPricer boxed(T, F, D);
+                boxed.build_grid(boxLower, boxUpper);
+                boxed.set_strikes(strikes);
+                boxed.set_params(params);
+                vector<double> boxCalls;
+                boxed.price_strikes(vector<PayoffType>(strikes.size(), PayoffType::Call), boxCalls);
+                for (size_t j = 0; j < strikes.size(); ++j)
+                {
+                    checked++;
+                    double error = abs(boxCalls[j] - reference[j]);
+                    maxError = max(maxError, error);
+                    if (error > 1e-6)
+                    {
+                        failures++;
+                        cout << "box grid, kappa " << params.kappa << " sigma " << params.sigma << " T = " << T
+                             << " K = " << strikes[j] << " | call " << boxCalls[j] << " reference " << reference[j] << "\n";
+                    }
+                }
+            }
+            for (size_t j = 0; j < strikes.size(); ++j)
+            {
+                double K = strikes[j];
+                checked++;
+                double error = abs(calls[j] - reference[j]);
+                maxError = max(maxError, error);
+                bool bounds = calls[j] >= D * max(0.0, F - K) - 1e-8 && calls[j] <= D * F &&
+                              puts[j] >= D * max(0.0, K - F) - 1e-8 && puts[j] <= D * K;
+                if (error > 1e-6 || !bounds)
+                {
+                    failures++;
+                    cout << "kappa " << params.kappa << " sigma " << params.sigma << " rho " << params.rho << " T = " << T
+                         << " K = " << K << " | call " << calls[j] << " reference " << reference[j] << " put " << puts[j] << "\n";
+                }
+            }
+        }
+        cout << checked << " prices, max error " << maxError << ", " << failures << " failures\n";
+        return failures;
+    }
+
+    // American price on a Cox-Ross-Rubinstein tree, the reference of the analytic approximations
+    double binomial_american(const BlackScholes &model, double vol, int steps)
+    {
+        double S = model.get_spot(), K = model.get_strike(), T = model.get_time_to_maturity();
+        double r = model.get_interest_rate(), q = model.get_dividend_yield();
+        double phi = static_cast<double>(model.get_payoff_type());
+        double dt = T / steps, up = exp(vol * sqrt(dt)), p = (exp((r - q) * dt) - 1 / up) / (up - 1 / up);
+        double discount = exp(-r * dt);
+        // spots[steps + k] = S up^k, node i of step n sits at up^(n - 2i)
+        vector<double> spots(2 * steps + 1), values(steps + 1);
+        spots[steps] = S;
+        for (int k = 1; k <= steps; ++k)
+        {
+            spots[steps + k] = spots[steps + k - 1] * up;
+            spots[steps - k] = spots[steps - k + 1] / up;
+        }
+        for (int i = 0; i <= steps; ++i)
+            values[i] = max(0.0, phi * (spots[2 * steps - 2 * i] - K));
+        for (int n = steps - 1; n >= 0; --n)
+            for (int i = 0; i <= n; ++i)
+                values[i] = max(discount * (p * values[i] + (1 - p) * values[i + 1]), phi * (spots[steps + n - 2 * i] - K));
+        return values[0];
+    }
+
+    // Barone-Adesi-Whaley and Bjerksund-Stensland against a 2000 step tree: both at least the European and
+    // the exercise value, Bjerksund-Stensland a lower bound, both within 2% of the strike (Barone-Adesi-Whaley
+    // drifts furthest on long-dated in-the-money contracts); then price -> IV -> price through the batched
+    // solve of a whole expiry, recovering the vol wherever the price is off the exercise value and the
+    // American vega is large enough to pin it down
+    int test_american()
+    {
+        cout << "\nAmerican approximations vs binomial tree:\n";
+        int failures = 0;
+        size_t checked = 0;
+        double maxBaw = 0, maxBs93 = 0;
+        for_each_model([&](const BlackScholes &model)
+                       {
+            if (model.get_time_to_maturity() > 1.0)
+                return; // keeps the trees cheap, the long-dated end is covered by the round trip
+            double intrinsic = max(0.0, static_cast<double>(model.get_payoff_type()) * (model.get_spot() - model.get_strike()));
+            for (double vol : {0.2, 0.6})
+            {
+                double european = model(vol);
+                double tree = binomial_american(model, vol, 2000);
+                double baw = model.with_early_exercise(EarlyExercise::BaroneAdesiWhaley)(vol);
+                double bs93 = model.with_early_exercise(EarlyExercise::BjerksundStensland)(vol);
+                double tolerance = 0.02 * model.get_strike();
+                checked++;
+                maxBaw = max(maxBaw, abs(baw - tree));
+                maxBs93 = max(maxBs93, abs(bs93 - tree));
+                bool bounds = baw >= european - 1e-12 && bs93 >= european - 1e-12 && baw >= intrinsic && bs93 >= intrinsic;
+                // the tree's own discretisation error is well under 1e-2 of these prices
+                if (!bounds || bs93 > tree + 1e-2 || abs(baw - tree) > tolerance || abs(bs93 - tree) > tolerance)
+                {
+                    failures++;
+                    cout << "K = " << model.get_strike() << " T = " << model.get_time_to_maturity() << " vol = " << vol
+                         << " | european " << european << " tree " << tree << " baw " << baw << " bs93 " << bs93 << "\n";
+                }
+            } });
+
+        const double S = 100, r = 0.04, q = 0.015;
+        for (EarlyExercise earlyExercise : {EarlyExercise::BaroneAdesiWhaley, EarlyExercise::BjerksundStensland})
+            for (double T : {0.02, 0.25, 1.0, 3.0})
+                for (double vol : {0.05, 0.2, 0.6, 1.5})
+                {
+                    vector<double> strikes, phis, prices, vols;
+                    for (double phi : {1.0, -1.0})
+                        for (double K : {60.0, 80.0, 95.0, 100.0, 105.0, 120.0, 150.0})
+                        {
+                            PayoffType type = phi > 0 ? PayoffType::Call : PayoffType::Put;
+                            strikes.push_back(K);
+                            phis.push_back(phi);
+                            prices.push_back(BlackScholes(K, S, T, r, type, q).with_early_exercise(earlyExercise)(vol));
+                        }
+                    vols.resize(strikes.size());
+                    american_implied_vol_batch(earlyExercise, S, r, q, T, strikes.size(), strikes.data(), phis.data(),
+                                               prices.data(), vols.data());
+                    for (size_t i = 0; i < strikes.size(); ++i)
+                    {
+                        BlackScholes model = BlackScholes(strikes[i], S, T, r, phis[i] > 0 ? PayoffType::Call : PayoffType::Put, q)
+                                                 .with_early_exercise(earlyExercise);
+                        double intrinsic = max(0.0, phis[i] * (S - strikes[i]));
+                        // at the exercise value, or below the bracket's lowest price, no vol is singled out
+                        if (prices[i] - max(intrinsic, model(minIV)) < 1e-6)
+                            continue;
+                        checked++;
+                        double vega = (model(vol + 1e-4) - model(vol - 1e-4)) / 2e-4;
+                        double priceError = abs(model(vols[i]) - prices[i]);
+                        if (!(priceError <= 1e-5) || (vega > 0.1 && abs(vols[i] - vol) > 1e-4))
+                        {
+                            failures++;
+                            cout << (earlyExercise == EarlyExercise::BaroneAdesiWhaley ? "baw" : "bs93") << " K = " << strikes[i]
+                                 << " T = " << T << " vol = " << vol << " | IV = " << vols[i] << " | price error = " << priceError << "\n";
+                        }
+                    }
+                }
+        cout << checked << " checks, max tree error baw " << maxBaw << " bs93 " << maxBs93 << ", " << failures << " failures\n";
+        return failures;
+    }
+
+    // a solved chain survives the compact records within the documented bounds: quotes and results to a
+    // relative 2^-23, expirations, maturities and types exactly, and the diagnostic side table bit for bit
+    int test_compact_chain(const Tickers &day1)
+    {
+        cout << "\nCompact chain round trip:\n";
+        int failures = 0;
+        size_t checked = 0;
+        auto close = [](double value, double expected)
+        { return abs(value - expected) <= 0x1p-23 * abs(expected); };
+        for (const auto &[name, ticker] : day1)
+        {
+            const auto &options = ticker->getOptions();
+            CompactChain compact = CompactChain::from_ticker(*ticker);
+            CompactChain diagnostics = CompactChain::from_ticker(*ticker, true);
+            if (compact.size() != options.size())
+            {
+                cout << name << ": " << compact.size() << " compact records for " << options.size() << " contracts\n";
+                failures++;
+                continue;
+            }
+            for (size_t i = 0; i < options.size(); ++i)
+            {
+                const OptionData &option = *options[i];
+                OptionData small = compact.expand(i), full = diagnostics.expand(i);
+                checked++;
+                bool same = small.expiration == option.expiration && small.timeToMaturity == option.timeToMaturity &&
+                            small.optionType == option.optionType && small.inTheMoney == option.inTheMoney &&
+                            close(small.strike, option.strike) && close(small.lastPrice, option.lastPrice) &&
+                            close(small.bid, option.bid) && close(small.ask, option.ask) &&
+                            close(small.volume, option.volume) && close(small.openInterest, option.openInterest) &&
+                            close(small.implied_vol(), option.implied_vol()) && close(small.delta_bs, option.delta_bs) &&
+                            close(small.gamma_bs, option.gamma_bs) && close(small.vega_bs, option.vega_bs) &&
+                            close(small.parity_price, option.parity_price) && close(small.bs_price, option.bs_price);
+                bool sideTable = full.bisectionImpliedVol == option.bisectionImpliedVol &&
+                                 full.newtonImpliedVol == option.newtonImpliedVol &&
+                                 full.secantImpliedVol == option.secantImpliedVol && full.delta_fd == option.delta_fd &&
+                                 full.gamma_fd == option.gamma_fd && full.vega_fd == option.vega_fd &&
+                                 full.parity_residual == option.parity_residual;
+                if (!same || !sideTable)
+                {
+                    failures++;
+                    if (failures <= 20)
+                        cout << name << " " << option.expiration << " " << option.strike << " " << option.optionType
+                             << (same ? "" : " | compact record out of bounds") << (sideTable ? "" : " | side table differs") << "\n";
+                }
+            }
+        }
+        cout << checked << " contracts, " << sizeof(CompactContract) << " bytes a record, " << failures << " failures\n";
+        return failures;
+    }
+
+    // write the day 1 chains back out as a dump directory, the equities as yfinance calls/puts csv files in
+    // reverse strike order and the indices as Yahoo json, and read it back: the merged chains must be the
+    // loaded ones contract for contract
+    int test_dump_directory(const Paths &paths, const Tickers &day1)
+    {
+        cout << "\nChain dump directory ingestion:\n";
+        string directory = paths.outputDir + "/dumps";
+        filesystem::remove_all(directory);
+        filesystem::create_directories(directory);
+        ofstream market(directory + "/market.csv");
+        market << setprecision(17) << "ticker,spotPrice,interestRate,asOf\n";
+
+        for (const auto &[name, ticker] : day1)
+        {
+            // the download date the maturities were counted from
+            const ExpirySlice &first = ticker->getSlices().front();
+            int year, month, day;
+            char dash;
+            istringstream(first.expiration) >> year >> dash >> month >> dash >> day;
+            chrono::sys_days asOf = chrono::sys_days{chrono::year{year} / month / day} -
+                                    chrono::days{lround(first.timeToMaturity * 365)};
+            chrono::year_month_day date{asOf};
+            market << name << "," << ticker->getSpotPrice() << "," << ticker->getInterestRate() * 100 << ","
+                   << static_cast<int>(date.year()) << "-" << setfill('0') << setw(2) << static_cast<unsigned>(date.month())
+                   << "-" << setw(2) << static_cast<unsigned>(date.day()) << setfill(' ') << "\n";
+
+            const auto &options = ticker->getOptions();
+            for (const ExpirySlice &slice : ticker->getSlices())
+            {
+                auto field = [](double value)
+                { ostringstream text; text << setprecision(17) << value; return text.str(); };
+                if (ticker->getUnderlyingType() == UnderlyingType::Equity)
+                {
+                    for (bool put : {false, true})
+                    {
+                        ofstream file(directory + "/" + name + "_" + slice.expiration + (put ? "_puts.csv" : "_calls.csv"));
+                        file << ",contractSymbol,strike,lastPrice,bid,ask,volume,openInterest,impliedVolatility,inTheMoney\n";
+                        size_t begin = put ? slice.putBegin : slice.callBegin, end = put ? slice.end : slice.putBegin;
+                        for (size_t i = end; i-- > begin;)
+                        {
+                            const OptionData &o = *options[i];
+                            file << i << "," << name << i << "," << field(o.strike) << "," << field(o.lastPrice) << ","
+                                 << field(o.bid) << "," << field(o.ask) << "," << field(o.volume) << ","
+                                 << field(o.openInterest) << "," << field(o.impliedVolatility) << ","
+                                 << (o.inTheMoney ? "True" : "False") << "\n";
+                        }
+                    }
+                    continue;
+                }
+                ofstream file(directory + "/" + name + "_" + slice.expiration + ".json");
+                file << "{\"optionChain\":{\"result\":[{\"underlyingSymbol\":\"" << name << "\",\"options\":[{";
+                for (bool put : {false, true})
+                {
+                    file << (put ? ",\"puts\":[" : "\"calls\":[");
+                    size_t begin = put ? slice.putBegin : slice.callBegin, end = put ? slice.end : slice.putBegin;
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const OptionData &o = *options[i];
+                        file << (i > begin ? "," : "") << "{\"contractSymbol\":\"" << name << i
+                             << "\",\"strike\":" << field(o.strike) << ",\"lastPrice\":" << field(o.lastPrice)
+                             << ",\"bid\":{\"raw\":" << field(o.bid) << ",\"fmt\":\"x\"},\"ask\":" << field(o.ask)
+                             << ",\"volume\":" << field(o.volume) << ",\"openInterest\":" << field(o.openInterest)
+                             << ",\"impliedVolatility\":" << field(o.impliedVolatility)
+                             << ",\"inTheMoney\":" << (o.inTheMoney ? "true" : "false") << "}";
+                    }
+                    file << "]";
+                }
+                file << "}]}],\"error\":null}}";
+            }
+        }
+        // a malformed row is skipped rather than failing the whole load
+        market << "BAD,n/a,4.5,2025-01-02\n";
+        market.close();
+
+        Tickers merged;
+        size_t contracts = read_chain_dump_directory(directory, merged);
+        int failures = 0;
+        for (const auto &[name, ticker] : day1)
+        {
+            auto it = merged.find(name);
+            const auto &options = ticker->getOptions();
+            if (it == merged.end() || it->second->getOptions().size() != options.size())
+            {
+                cout << name << ": chain not merged back\n";
+                failures++;
+                continue;
+            }
+            const Ticker &back = *it->second;
+            failures += abs(back.getSpotPrice() - ticker->getSpotPrice()) > 1e-12 ||
+                        abs(back.getInterestRate() - ticker->getInterestRate()) > 1e-12;
+            for (size_t i = 0; i < options.size(); ++i)
+            {
+                const OptionData &a = *options[i], &b = *back.getOptions()[i];
+                if (a.expiration != b.expiration || a.timeToMaturity != b.timeToMaturity || a.strike != b.strike ||
+                    a.optionType != b.optionType || a.lastPrice != b.lastPrice || a.bid != b.bid || a.ask != b.ask ||
+                    a.volume != b.volume || a.openInterest != b.openInterest ||
+                    a.impliedVolatility != b.impliedVolatility || a.inTheMoney != b.inTheMoney)
+                {
+                    failures++;
+                    if (failures <= 20)
+                        cout << name << " contract " << i << " " << a.expiration << " " << a.strike << " " << a.optionType
+                             << " merged as " << b.expiration << " " << b.strike << " " << b.optionType << "\n";
+                }
+            }
+        }
+
+        // the compact reader appends the same merged expirations without going through a Ticker
+        unordered_map<string, CompactChain> chains;
+        failures += read_chain_dump_directory(directory, chains) != contracts;
+        for (const auto &[name, ticker] : merged)
+        {
+            auto it = chains.find(name);
+            CompactChain expected = CompactChain::from_ticker(*ticker);
+            if (it == chains.end() || it->second.size() != expected.size() ||
+                it->second.expiries().size() != expected.expiries().size())
+            {
+                cout << name << ": compact chain not merged back\n";
+                failures++;
+                continue;
+            }
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                const CompactContract &a = expected.records()[i], &b = it->second.records()[i];
+                failures += a.strike != b.strike || a.lastPrice != b.lastPrice || a.bid != b.bid || a.ask != b.ask ||
+                            a.volume != b.volume || a.openInterest != b.openInterest ||
+                            a.impliedVolatility != b.impliedVolatility || a.expiry != b.expiry || a.flags != b.flags;
+            }
+        }
+        cout << contracts << " contracts merged, " << failures << " failures\n";
+        return failures;
+    }
+
+    int test_properties(const Paths &paths)
+    {
+        Tickers day1, day2;
+        run_pipeline(paths, day1, day2);
+        return test_put_call_parity() + test_greeks_fd_vs_analytic(day1) + test_solver_round_trip() + test_heston_reference() + test_american() +
+               test_compact_chain(day1) + test_dump_directory(paths, day1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Paths paths;
+    string suite = "all";
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--update")
+            paths.update = true;
+        else if (arg == "--data-dir" && i + 1 < argc)
+            paths.dataDir = argv[++i];
+        else if (arg == "--golden-dir" && i + 1 < argc)
+            paths.goldenDir = argv[++i];
+        else if (arg == "--output-dir" && i + 1 < argc)
+            paths.outputDir = argv[++i];
+        else if (arg == "golden" || arg == "properties" || arg == "all")
+            suite = arg;
+        else
+        {
+            cerr << "usage: " << argv[0]
+                 << " [golden|properties|all] [--data-dir <dir>] [--golden-dir <dir>] [--output-dir <dir>] [--update]\n";
+            return 2;
+        }
+    }
+
+    int failures = 0;
+    if (suite != "properties")
+        failures += test_golden(paths);
+    if (suite != "golden" && !paths.update)
+        failures += test_properties(paths);
+
+    cout << "\n"
+         << failures << " failures\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -15,10 +15,33 @@ double norm_pdf(double x)
     return std::exp(-0.5 * x * x) / std::sqrt(2 * std::numbers::pi);
 }
 
-double bisection_method(BlackScholes &bs, double market_price, bool debug)
+double bisection_method(BlackScholes &bs, double market_price, bool debug, double initial_guess, int *iterations)
 {
     double a = 0.0001;
     double b = 3.0;
+
+    // **Warm start: shrink the bracket around the guess, widening it until it holds the root**
+    if (initial_guess > a && initial_guess < b)
+    {
+        double lo = std::max(a, 0.9 * initial_guess);
+        double hi = std::min(b, 1.1 * initial_guess);
+        while (lo > a && bs(lo) > market_price)
+        {
+            lo = std::max(a, 0.5 * lo);
+        }
+        while (hi < b && bs(hi) < market_price)
+        {
+            hi = std::min(b, 2 * hi);
+        }
+
+        // keep the full range if the root is outside it, so the result matches a cold start
+        if ((bs(lo) - market_price) * (bs(hi) - market_price) <= 0)
+        {
+            a = lo;
+            b = hi;
+        }
+    }
+
     double c = (a + b) / 2;
     double epsilon = 1e-06;
     double tol = bs(c) - market_price;
@@ -34,6 +57,8 @@ double bisection_method(BlackScholes &bs, double market_price, bool debug)
 
     if (fa * fb > 0)
     {
+        if (iterations)
+            *iterations = 0;
         if (debug)
             std::cout << "Warning: Root is not in range! Returning best estimate.\n";
         return std::min(std::max(epsilon, a), b);
@@ -67,6 +92,8 @@ double bisection_method(BlackScholes &bs, double market_price, bool debug)
 
     if (debug)
         std::cout << "Ending Bisection Method after " << iter << " iterations.\n";
+    if (iterations)
+        *iterations = iter;
 
     // **Ensure valid output within IV range**
     c = std::max(epsilon, std::min(c, b));
@@ -74,9 +101,9 @@ double bisection_method(BlackScholes &bs, double market_price, bool debug)
     return c;
 }
 
-double newton_method(BlackScholes &bs, double market_price)
+double newton_method(BlackScholes &bs, double market_price, double initial_guess, int *iterations)
 {
-    double sigma = 2; // Initial guess
+    double sigma = initial_guess; // Initial guess
     double epsilon = 1e-06;
     int max_iter = 100;
 
@@ -87,6 +114,8 @@ double newton_method(BlackScholes &bs, double market_price)
 
         if (std::abs(price - market_price) < epsilon || vega <= 0.0)
         {
+            if (iterations)
+                *iterations = i;
             return sigma;
         }
 
@@ -94,13 +123,15 @@ double newton_method(BlackScholes &bs, double market_price)
         sigma -= (price - market_price) / vega;
     }
 
+    if (iterations)
+        *iterations = max_iter;
     return sigma; // Return the last computed sigma
 }
 
-double secant_method(BlackScholes &bs, double market_price)
+double secant_method(BlackScholes &bs, double market_price, double initial_guess, int *iterations)
 {
-    double sigma0 = 2; // Initial guess 1
-    double sigma1 = 3; // Initial guess 2
+    double sigma0 = initial_guess;       // Initial guess 1
+    double sigma1 = 1.5 * initial_guess; // Initial guess 2
     double epsilon = 1e-06;
     int max_iter = 100;
 
@@ -111,6 +142,8 @@ double secant_method(BlackScholes &bs, double market_price)
 
         if (std::abs(f_sigma1) < epsilon)
         {
+            if (iterations)
+                *iterations = i;
             return sigma1; // Converged
         }
 
@@ -118,6 +151,8 @@ double secant_method(BlackScholes &bs, double market_price)
         double denominator = (f_sigma1 - f_sigma0);
         if (std::abs(denominator) < epsilon)
         {
+            if (iterations)
+                *iterations = i;
             return sigma1;
         }
 
@@ -129,6 +164,8 @@ double secant_method(BlackScholes &bs, double market_price)
         sigma1 = sigma2;
     }
 
+    if (iterations)
+        *iterations = max_iter;
     return sigma1; // Return the last computed sigma
 }
 
@@ -138,8 +175,8 @@ double delta_finite_difference(BlackScholes &bs, double vol)
     double S = bs.get_spot();
 
     // Compute price at S+h and S-h
-    BlackScholes bs_plus(bs.get_strike(), S + h, bs.get_time_to_maturity(), bs.get_interest_rate(), bs.get_payoff_type(), 0.0);
-    BlackScholes bs_minus(bs.get_strike(), S - h, bs.get_time_to_maturity(), bs.get_interest_rate(), bs.get_payoff_type(), 0.0);
+    BlackScholes bs_plus = bs.with_spot(S + h);
+    BlackScholes bs_minus = bs.with_spot(S - h);
     // Approximate derivative using central difference formula
     return (bs_plus(vol) - bs_minus(vol)) / (2 * h);
 }
@@ -150,8 +187,8 @@ double gamma_finite_difference(BlackScholes &bs, double vol)
     double S = bs.get_spot();
 
     // Compute Delta at S+h and S-h
-    BlackScholes bs_plus(bs.get_strike(), S + h, bs.get_time_to_maturity(), bs.get_interest_rate(), bs.get_payoff_type(), 0.0);
-    BlackScholes bs_minus(bs.get_strike(), S - h, bs.get_time_to_maturity(), bs.get_interest_rate(), bs.get_payoff_type(), 0.0);
+    BlackScholes bs_plus = bs.with_spot(S + h);
+    BlackScholes bs_minus = bs.with_spot(S - h);
 
     double delta_plus = delta_finite_difference(bs_plus, vol);
     double delta_minus = delta_finite_difference(bs_minus, vol);
@@ -14,14 +14,16 @@ double norm_cdf(double x);
 // Normal PDF function
 double norm_pdf(double x);
 
-// Bisection Method
-double bisection_method(BlackScholes &bs, double market_price, bool debug = false);
+// the root finders store the number of iterations they took in *iterations when it is not null
+
+// Bisection Method (initial_guess > 0 narrows the starting bracket around a warm-start vol)
+double bisection_method(BlackScholes &bs, double market_price, bool debug = false, double initial_guess = 0, int *iterations = nullptr);
 
 // Newton's Method
-double newton_method(BlackScholes &bs, double market_price);
+double newton_method(BlackScholes &bs, double market_price, double initial_guess = 2, int *iterations = nullptr);
 
-// Secant Method
-double secant_method(BlackScholes &bs, double market_price);
+// Secant Method (second point starts at 1.5 times the initial guess)
+double secant_method(BlackScholes &bs, double market_price, double initial_guess = 2, int *iterations = nullptr);
 
 // Calculate Delta using Finite Difference
 double delta_finite_difference(BlackScholes &bs, double vol);